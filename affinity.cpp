@@ -0,0 +1,48 @@
+#include "affinity.h"
+#include <pthread.h>
+#include <sched.h>
+
+
+/**
+ * Returns the CPU set the process was started with. It is captured on the first call, before any thread pinned
+ * itself, so later pinning of the calling thread doesn't shrink it.
+ * @return - the allowed CPU set of the process.
+ */
+static const cpu_set_t& process_cpu_set()
+{
+    static const cpu_set_t set = []() {
+        cpu_set_t s;
+        if (sched_getaffinity(0, sizeof(s), &s) != 0) {
+            CPU_ZERO(&s);
+            CPU_SET(0, &s);
+        }
+        return s;
+    }();
+    return set;
+}
+
+int allowed_cpu_count()
+{
+    int count = CPU_COUNT(&process_cpu_set());
+    return count > 0 ? count : 1;
+}
+
+int allowed_cpu(int slot)
+{
+    const cpu_set_t& set = process_cpu_set();
+    int wanted = slot % allowed_cpu_count();
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set) && wanted-- == 0) {
+            return cpu;
+        }
+    }
+    return 0;
+}
+
+int pin_current_thread(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
@@ -0,0 +1,28 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+
+/**
+ * Returns the number of CPUs this process is allowed to run on.
+ * @return - the number of allowed CPUs (at least 1).
+ */
+int allowed_cpu_count();
+
+
+/**
+ * Maps a logical thread slot to one of the CPUs this process is allowed to run on, wrapping around when there are
+ * more slots than CPUs.
+ * @param slot - the logical slot (0, 1, 2, ...).
+ * @return - the id of the CPU for that slot.
+ */
+int allowed_cpu(int slot);
+
+
+/**
+ * Pins the calling thread to a single CPU.
+ * @param cpu - the id of the CPU to run on.
+ * @return 0 on success, -1 on failure.
+ */
+int pin_current_thread(int cpu);
+
+#endif
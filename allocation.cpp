@@ -0,0 +1,238 @@
+#include "allocation.h"
+#include "topology.h"
+#include <linux/mempolicy.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define MAX_NUMA_NODES 1024
+#define HUGE_PAGE_2M (2ULL << 20)
+#define HUGE_PAGE_1G (1ULL << 30)
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MFD_HUGE_SHIFT
+#define MFD_HUGE_SHIFT 26
+#endif
+
+/**
+ * Binds a page-aligned range of memory to a single NUMA node.
+ * @return 0 on success, -1 on failure.
+ */
+static int bind_to_node(void* addr, uint64_t bytes, int node)
+{
+    if (node < 0 || node >= MAX_NUMA_NODES) {
+        return -1;
+    }
+    unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+    if (syscall(SYS_mbind, addr, bytes, MPOL_BIND, mask, MAX_NUMA_NODES + 1, 0) == 0) {
+        return 0;
+    }
+    // A kernel without NUMA support only has node 0, where the memory lands anyway.
+    return (node == 0 && numa_node_count() == 1) ? 0 : -1;
+}
+
+/**
+ * Returns the length of the mapping behind an array: huge page backings are rounded up to whole huge pages.
+ */
+static uint64_t mapped_length(uint64_t bytes, enum page_backing backing)
+{
+    uint64_t page = backing == BACKING_1G ? HUGE_PAGE_1G :
+                    (backing == BACKING_2M || backing == BACKING_THP) ? HUGE_PAGE_2M : 1;
+    return (bytes + page - 1) / page * page;
+}
+
+/**
+ * Maps a range for transparent huge pages: over-maps and trims it so it starts on a 2MB boundary, then asks for huge
+ * pages with madvise.
+ */
+static void* map_thp(uint64_t length)
+{
+    char* raw = (char*)mmap(NULL, length + HUGE_PAGE_2M, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return MAP_FAILED;
+    }
+    char* aligned = (char*)(((uintptr_t)raw + HUGE_PAGE_2M - 1) & ~(uintptr_t)(HUGE_PAGE_2M - 1));
+    if (aligned > raw) {
+        munmap(raw, aligned - raw);
+    }
+    if (raw + HUGE_PAGE_2M > aligned) {
+        munmap(aligned + length, raw + HUGE_PAGE_2M - aligned);
+    }
+    madvise(aligned, length, MADV_HUGEPAGE);
+    return aligned;
+}
+
+int parse_page_backing(const char* name)
+{
+    if (strcmp(name, "4k") == 0) return BACKING_4K;
+    if (strcmp(name, "thp") == 0) return BACKING_THP;
+    if (strcmp(name, "2m") == 0) return BACKING_2M;
+    if (strcmp(name, "1g") == 0) return BACKING_1G;
+    return -1;
+}
+
+void* alloc_array(uint64_t bytes, int node, enum page_backing backing)
+{
+    uint64_t length = mapped_length(bytes, backing);
+    void* arr = MAP_FAILED;
+    switch (backing) {
+        case BACKING_THP:
+            arr = map_thp(length);
+            break;
+        case BACKING_2M:
+        case BACKING_1G:
+            arr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                       (backing == BACKING_2M ? MAP_HUGE_2MB : MAP_HUGE_1GB), -1, 0);
+            static bool warned = false;
+            if (arr == MAP_FAILED && !warned) {
+                warned = true;
+                fprintf(stderr, "Warning: no %s huge pages available, falling back to the default pages\n",
+                        backing == BACKING_2M ? "2MB" : "1GB");
+            }
+            break;
+        default:
+            break;
+    }
+    if (arr == MAP_FAILED) {
+        arr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (arr == MAP_FAILED) {
+            return NULL;
+        }
+        if (backing == BACKING_4K) {
+            madvise(arr, length, MADV_NOHUGEPAGE);
+        }
+    }
+    if (node >= 0 && bind_to_node(arr, length, node) != 0) {
+        munmap(arr, length);
+        return NULL;
+    }
+    return arr;
+}
+
+int prefault_array(void* arr, uint64_t bytes, bool lock)
+{
+    if (madvise(arr, bytes, MADV_POPULATE_WRITE) != 0) {
+        // Older kernels: touch every page ourselves.
+        const uint64_t page = sysconf(_SC_PAGESIZE);
+        volatile char* bytes_of = (volatile char*)arr;
+        for (uint64_t offset = 0; offset < bytes; offset += page) {
+            bytes_of[offset] = 0;
+        }
+    }
+    if (lock && mlock(arr, bytes) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+void free_array(void* arr, uint64_t bytes, enum page_backing backing)
+{
+    if (arr != NULL) {
+        munmap(arr, mapped_length(bytes, backing));
+    }
+}
+
+void* alloc_aliased_array(uint64_t pages, uint64_t page_size, int node)
+{
+    const uint64_t base_page = sysconf(_SC_PAGESIZE);
+    unsigned int flags = MFD_CLOEXEC;
+    if (page_size != base_page) {
+        flags |= MFD_HUGETLB | ((unsigned int)__builtin_ctzll(page_size) << MFD_HUGE_SHIFT);
+    }
+    int fd = memfd_create("memlat-aliased", flags);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, page_size) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // Reserve an aligned range first, then map every view over it.
+    uint64_t length = pages * page_size;
+    char* raw = (char*)mmap(NULL, length + page_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    char* aligned = (char*)(((uintptr_t)raw + page_size - 1) & ~(uintptr_t)(page_size - 1));
+    if (aligned > raw) {
+        munmap(raw, aligned - raw);
+    }
+    munmap(aligned + length, raw + page_size - aligned);
+
+    bool mapped = true;
+    for (uint64_t p = 0; p < pages && mapped; p++) {
+        mapped = mmap(aligned + p * page_size, page_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) !=
+                 MAP_FAILED;
+        // The policy of a memfd is shared by all its mappings, so binding the first view places the page.
+        if (mapped && p == 0 && node >= 0) {
+            mapped = bind_to_node(aligned, page_size, node) == 0;
+        }
+    }
+    close(fd);
+    if (!mapped || prefault_array(aligned, length, false) != 0) {
+        munmap(aligned, length);
+        return NULL;
+    }
+    return aligned;
+}
+
+void free_aliased_array(void* arr, uint64_t pages, uint64_t page_size)
+{
+    if (arr != NULL) {
+        munmap(arr, pages * page_size);
+    }
+}
+
+const char* describe_backing(const void* arr, char* buffer, size_t size)
+{
+    snprintf(buffer, size, "unknown");
+    FILE* smaps = fopen("/proc/self/smaps", "r");
+    if (smaps == NULL) {
+        return buffer;
+    }
+
+    // Find the mapping that holds arr, then read its fields until the next mapping starts.
+    char line[512];
+    bool inside = false;
+    uint64_t kernel_page_kb = 0, rss_kb = 0, thp_kb = 0;
+    while (fgets(line, sizeof(line), smaps) != NULL) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (inside) break;
+            inside = (uintptr_t)arr >= start && (uintptr_t)arr < end;
+            continue;
+        }
+        if (!inside) continue;
+        unsigned long value;
+        if (sscanf(line, "KernelPageSize: %lu kB", &value) == 1) kernel_page_kb = value;
+        else if (sscanf(line, "Rss: %lu kB", &value) == 1) rss_kb = value;
+        else if (sscanf(line, "AnonHugePages: %lu kB", &value) == 1) thp_kb = value;
+    }
+    fclose(smaps);
+
+    if (kernel_page_kb == HUGE_PAGE_1G / 1024) {
+        snprintf(buffer, size, "1G");
+    } else if (kernel_page_kb == HUGE_PAGE_2M / 1024) {
+        snprintf(buffer, size, "2M");
+    } else if (thp_kb > 0 && rss_kb > 0) {
+        snprintf(buffer, size, "thp:%lu%%", (unsigned long)(100 * thp_kb / rss_kb));
+    } else if (kernel_page_kb > 0) {
+        snprintf(buffer, size, "%luK", (unsigned long)kernel_page_kb);
+    }
+    return buffer;
+}
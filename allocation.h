@@ -0,0 +1,92 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include "memory_latency.h"
+
+
+/**
+ * The kinds of pages that can back a measured array.
+ */
+enum page_backing {
+    BACKING_DEFAULT,    // whatever the system policy gives an anonymous mapping
+    BACKING_4K,         // 4K pages only, transparent huge pages disabled with madvise
+    BACKING_THP,        // transparent huge pages requested with madvise
+    BACKING_2M,         // explicit 2MB pages from hugetlbfs
+    BACKING_1G          // explicit 1GB pages from hugetlbfs
+};
+
+
+/**
+ * Parses the name of a page backing ('4k', 'thp', '2m' or '1g').
+ * @param name - the name to parse.
+ * @return - the page backing, or -1 if the name is unknown.
+ */
+int parse_page_backing(const char* name);
+
+
+/**
+ * Allocates a page-aligned array for measurement with an anonymous mapping. If a NUMA node is given, the mapping is
+ * bound to it (MPOL_BIND) before any page is touched, so the placement doesn't depend on which thread touches it first.
+ * On machines without NUMA support, binding to node 0 is accepted and ignored.
+ * Explicit huge pages that can't be allocated (e.g. none are reserved) fall back to the default backing, with a
+ * warning. Use describe_backing after the array was touched to see what was actually obtained.
+ * @param bytes - the size of the array in bytes.
+ * @param node - the id of the NUMA node to bind the array to, or -1 for the default policy.
+ * @param backing - the kind of pages to back the array with.
+ * @return - the allocated (untouched) array, or NULL on failure.
+ */
+void* alloc_array(uint64_t bytes, int node, enum page_backing backing);
+
+
+/**
+ * Faults in every page of an array up front, so the measurements never pay for page faults. Uses
+ * MADV_POPULATE_WRITE where the kernel supports it, and writes to every page otherwise.
+ * @param arr - an array allocated by alloc_array.
+ * @param bytes - the size of the array in bytes.
+ * @param lock - whether to also mlock the array, so it can't be swapped out or migrated.
+ * @return 0 on success, -1 if the array couldn't be locked.
+ */
+int prefault_array(void* arr, uint64_t bytes, bool lock);
+
+
+/**
+ * Frees an array allocated by alloc_array.
+ * @param arr - the array to free (may be NULL).
+ * @param bytes - the size of the array in bytes, as given to alloc_array.
+ * @param backing - the page backing, as given to alloc_array.
+ */
+void free_array(void* arr, uint64_t bytes, enum page_backing backing);
+
+
+/**
+ * Allocates an array of 'pages' virtual pages that all map the same physical page, from a memfd (hugetlbfs for huge
+ * pages), and faults every view in. The array spans many TLB entries while its data only takes one page of cache.
+ * The views are separate mappings, so 'pages' is bounded by vm.max_map_count.
+ * @param pages - the number of views.
+ * @param page_size - the size of the page: the base page size, 2MB or 1GB.
+ * @param node - the id of the NUMA node to bind the physical page to, or -1 for the default policy.
+ * @return - the array (zero filled), or NULL on failure, e.g. when no huge page of that size is reserved.
+ */
+void* alloc_aliased_array(uint64_t pages, uint64_t page_size, int node);
+
+
+/**
+ * Frees an array allocated by alloc_aliased_array.
+ * @param arr - the array to free (may be NULL).
+ * @param pages - the number of views, as given to alloc_aliased_array.
+ * @param page_size - the size of the page, as given to alloc_aliased_array.
+ */
+void free_aliased_array(void* arr, uint64_t pages, uint64_t page_size);
+
+
+/**
+ * Describes the pages that actually back a (touched) array, according to /proc/self/smaps: '4K', '2M' or '1G' for
+ * the page size of the mapping, or 'thp:<percent>%' for the share of the resident memory in transparent huge pages.
+ * @param arr - an array allocated by alloc_array.
+ * @param buffer - filled with the description.
+ * @param size - the size of buffer.
+ * @return - buffer.
+ */
+const char* describe_backing(const void* arr, char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,358 @@
+#include "memory_latency.h"
+#include "atomics.h"
+#include "topology.h"
+#include "affinity.h"
+#include "prng.h"
+#include <pthread.h>
+#include <atomic>
+#include <cmath>
+
+#define REMOTE_LINES 256    // the lines the owner of the remote measurement writes per pass, 16KB
+
+/**
+ * A cache line holding a single atomic variable, so every operation of the suite touches one line.
+ */
+struct alignas(64) atomic_line {
+    std::atomic<uint64_t> value;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+/**
+ * One operation of the suite on a variable, for a fixed memory order. The operations keep the variables of a fresh
+ * buffer at zero where they can, so compare_exchange_strong(0, 0) always succeeds.
+ * @return - the value the operation read, or 0 if it doesn't read.
+ */
+template <int OP, std::memory_order ORDER>
+struct atomic_step;
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_LOAD, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t) { return value.load(ORDER); }
+};
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_STORE, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t i) { value.store(i, ORDER); return 0; }
+};
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_XADD, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t) { return value.fetch_add(1, ORDER); }
+};
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_CMPXCHG, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t)
+    {
+        uint64_t expected = 0;
+        value.compare_exchange_strong(expected, 0, ORDER);
+        return expected;
+    }
+};
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_XCHG, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t i) { return value.exchange(i, ORDER); }
+};
+
+template <std::memory_order ORDER>
+struct atomic_step<ATOMIC_FENCE, ORDER> {
+    static inline uint64_t run(std::atomic<uint64_t>& value, uint64_t i)
+    {
+        value.store(i, std::memory_order_relaxed);
+        std::atomic_thread_fence(ORDER);
+        return 0;
+    }
+};
+
+/**
+ * The kernel of one variant: runs the operation 'repeat' times over the lines, in the order of the full period LCG
+ * scrambled by scramble_pow2, where the result of every operation feeds the choice of the next line. Operations that
+ * don't read feed their line instead, so the loop has the same dependency chain as the baseline.
+ * @param lines - the lines, a power of two of them.
+ * @param count - the number of lines.
+ * @param repeat - the number of operations.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param barrier - a barrier all the threads of a contended measurement wait on after their baselines, or NULL.
+ * @return struct measurement with the baseline and access times (ns) per operation, and NaN counters.
+ */
+template <int OP, std::memory_order ORDER>
+static struct measurement atomic_kernel(struct atomic_line* lines, uint64_t count, uint64_t repeat, uint64_t zero,
+                                        pthread_barrier_t* barrier)
+{
+    const uint64_t mask = count - 1;
+    const int shift = (__builtin_ctzll(count) + 1) / 2;
+
+    // Baseline measurement - the same line computation, without the operation:
+    uint64_t t0 = timer_now();
+    register uint64_t state = 0;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        uint64_t line = scramble_pow2(state, mask, shift);
+        state = (5 * state + 1 + (line & zero)) & mask;
+    }
+    uint64_t t1 = timer_now();
+
+    if (barrier != NULL) {
+        pthread_barrier_wait(barrier);
+    }
+
+    // Operation measurement:
+    uint64_t t2 = timer_now();
+    state &= zero;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        uint64_t line = scramble_pow2(state, mask, shift);
+        uint64_t read = atomic_step<OP, ORDER>::run(lines[line].value, i);
+        state = (5 * state + 1 + ((read ^ line) & zero)) & mask;
+    }
+    uint64_t t3 = timer_now();
+
+    struct measurement result;
+    result.baseline = timer_ticks_to_ns(t1 - t0) / repeat;
+    result.access_time = timer_ticks_to_ns(t3 - t2) / repeat;
+    result.rnd = state;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        result.counters[c] = NAN;
+    }
+    return result;
+}
+
+typedef struct measurement (*atomic_kernel_t)(struct atomic_line* lines, uint64_t count, uint64_t repeat,
+                                              uint64_t zero, pthread_barrier_t* barrier);
+
+/**
+ * A variant of the suite: an operation with one of the memory orders it accepts.
+ */
+struct atomic_variant {
+    const char* op_name;
+    const char* order_name;
+    atomic_kernel_t kernel;
+};
+
+#define ATOMIC_VARIANT(op, name, order) \
+    {name, #order, atomic_kernel<op, std::memory_order_##order>}
+
+static const struct atomic_variant VARIANTS[] = {
+    ATOMIC_VARIANT(ATOMIC_LOAD, "load", relaxed),
+    ATOMIC_VARIANT(ATOMIC_LOAD, "load", acquire),
+    ATOMIC_VARIANT(ATOMIC_LOAD, "load", seq_cst),
+    ATOMIC_VARIANT(ATOMIC_STORE, "store", relaxed),
+    ATOMIC_VARIANT(ATOMIC_STORE, "store", release),
+    ATOMIC_VARIANT(ATOMIC_STORE, "store", seq_cst),
+    ATOMIC_VARIANT(ATOMIC_XADD, "xadd", relaxed),
+    ATOMIC_VARIANT(ATOMIC_XADD, "xadd", acquire),
+    ATOMIC_VARIANT(ATOMIC_XADD, "xadd", release),
+    ATOMIC_VARIANT(ATOMIC_XADD, "xadd", acq_rel),
+    ATOMIC_VARIANT(ATOMIC_XADD, "xadd", seq_cst),
+    ATOMIC_VARIANT(ATOMIC_CMPXCHG, "cmpxchg", relaxed),
+    ATOMIC_VARIANT(ATOMIC_CMPXCHG, "cmpxchg", acquire),
+    ATOMIC_VARIANT(ATOMIC_CMPXCHG, "cmpxchg", release),
+    ATOMIC_VARIANT(ATOMIC_CMPXCHG, "cmpxchg", acq_rel),
+    ATOMIC_VARIANT(ATOMIC_CMPXCHG, "cmpxchg", seq_cst),
+    ATOMIC_VARIANT(ATOMIC_XCHG, "xchg", relaxed),
+    ATOMIC_VARIANT(ATOMIC_XCHG, "xchg", acquire),
+    ATOMIC_VARIANT(ATOMIC_XCHG, "xchg", release),
+    ATOMIC_VARIANT(ATOMIC_XCHG, "xchg", acq_rel),
+    ATOMIC_VARIANT(ATOMIC_XCHG, "xchg", seq_cst),
+    ATOMIC_VARIANT(ATOMIC_FENCE, "fence", acquire),
+    ATOMIC_VARIANT(ATOMIC_FENCE, "fence", release),
+    ATOMIC_VARIANT(ATOMIC_FENCE, "fence", acq_rel),
+    ATOMIC_VARIANT(ATOMIC_FENCE, "fence", seq_cst),
+};
+
+int atomic_variant_count()
+{
+    return sizeof(VARIANTS) / sizeof(VARIANTS[0]);
+}
+
+const char* atomic_variant_op_name(int variant)
+{
+    return VARIANTS[variant].op_name;
+}
+
+const char* atomic_variant_order_name(int variant)
+{
+    return VARIANTS[variant].order_name;
+}
+
+int measure_atomic_latency(int variant, uint64_t repeat, uint64_t bytes, int mem_node, enum page_backing backing,
+                           uint64_t zero, struct atomic_result* result)
+{
+    uint64_t count = 1;
+    while (count * 2 * sizeof(struct atomic_line) <= bytes) count *= 2;
+    uint64_t length = count * sizeof(struct atomic_line);
+    struct atomic_line* lines = (struct atomic_line*)alloc_array(length, mem_node, backing);
+    if (lines == NULL) {
+        return -1;
+    }
+    prefault_array(lines, length, false);
+
+    repeat = count > repeat ? count:repeat; // Make sure repeat >= count
+    struct measurement measurement = VARIANTS[variant].kernel(lines, count, repeat, zero, NULL);
+    result->latency = measurement.access_time - measurement.baseline;
+    result->throughput = 1000 / measurement.access_time;
+
+    free_array(lines, length, backing);
+    return 0;
+}
+
+/**
+ * The state shared by the measuring thread and the owner of the lines of the remote measurement.
+ */
+struct remote_shared {
+    struct atomic_line* lines;
+    uint64_t passes;
+    int owner_cpu;
+    std::atomic<uint64_t> turn;     // 2 * pass while the owner writes, 2 * pass + 1 once it wrote them
+};
+
+/**
+ * The body of the owner thread: writes every line at the start of every pass, so they are modified in its cache.
+ */
+static void* remote_owner(void* arg)
+{
+    struct remote_shared* shared = (struct remote_shared*)arg;
+    pin_current_thread(shared->owner_cpu);
+    for (uint64_t pass = 0; pass < shared->passes; pass++) {
+        while (shared->turn.load(std::memory_order_acquire) != 2 * pass) {
+        }
+        for (int l = 0; l < REMOTE_LINES; l++) {
+            shared->lines[l].value.store(0, std::memory_order_relaxed);
+        }
+        shared->turn.store(2 * pass + 1, std::memory_order_release);
+    }
+    return NULL;
+}
+
+int measure_atomic_remote(int variant, uint64_t repeat, int cpu, int owner_cpu, uint64_t zero,
+                          struct atomic_result* result)
+{
+    const uint64_t length = REMOTE_LINES * sizeof(struct atomic_line);
+    struct remote_shared shared;
+    shared.lines = (struct atomic_line*)alloc_array(length, -1, BACKING_DEFAULT);
+    if (shared.lines == NULL) {
+        return -1;
+    }
+    shared.passes = (repeat + REMOTE_LINES - 1) / REMOTE_LINES;
+    shared.owner_cpu = owner_cpu;
+    shared.turn.store(1);
+
+    pin_current_thread(cpu);
+    pthread_t owner;
+    if (pthread_create(&owner, NULL, remote_owner, &shared) != 0) {
+        free_array(shared.lines, length, BACKING_DEFAULT);
+        return -1;
+    }
+
+    double baseline = 0, access_time = 0;
+    for (uint64_t pass = 0; pass < shared.passes; pass++) {
+        shared.turn.store(2 * pass, std::memory_order_release);
+        while (shared.turn.load(std::memory_order_acquire) != 2 * pass + 1) {
+        }
+        struct measurement measurement = VARIANTS[variant].kernel(shared.lines, REMOTE_LINES, REMOTE_LINES, zero,
+                                                                  NULL);
+        baseline += measurement.baseline;
+        access_time += measurement.access_time;
+    }
+    pthread_join(owner, NULL);
+    result->latency = (access_time - baseline) / shared.passes;
+    result->throughput = 1000 * shared.passes / access_time;
+
+    free_array(shared.lines, length, BACKING_DEFAULT);
+    return 0;
+}
+
+/**
+ * The state shared by all the threads of one contended measurement.
+ */
+struct contention_shared {
+    struct atomic_line line;
+    atomic_kernel_t kernel;
+    uint64_t repeat;
+    uint64_t zero;
+    int cpu_node;
+    pthread_barrier_t barrier;
+    std::atomic<int> start;         // 0 while the threads are created, then 1 to run or -1 to quit
+};
+
+/**
+ * The arguments and result of a single contending thread.
+ */
+struct contention_worker {
+    struct contention_shared* shared;
+    int id;
+    struct measurement measurement;
+};
+
+/**
+ * The body of a contending thread: pins itself and runs the kernel on the shared line.
+ */
+static void* contention_thread(void* arg)
+{
+    struct contention_worker* worker = (struct contention_worker*)arg;
+    struct contention_shared* shared = worker->shared;
+    pin_current_thread(numa_node_cpu(shared->cpu_node, worker->id));
+    while (shared->start.load(std::memory_order_acquire) == 0) {
+    }
+    if (shared->start.load(std::memory_order_relaxed) < 0) {
+        return NULL;
+    }
+    worker->measurement = shared->kernel(&shared->line, 1, shared->repeat, shared->zero, &shared->barrier);
+    return NULL;
+}
+
+int measure_atomic_contention(int variant, uint64_t repeat, int threads, int cpu_node, uint64_t zero,
+                              struct atomic_result* result)
+{
+    struct contention_shared shared;
+    shared.line.value.store(0);
+    shared.kernel = VARIANTS[variant].kernel;
+    shared.repeat = repeat;
+    shared.zero = zero;
+    shared.cpu_node = cpu_node;
+
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    struct contention_worker* workers = (struct contention_worker*)malloc(threads *
+                                                                          sizeof(struct contention_worker));
+    if (tids == NULL || workers == NULL) {
+        free(tids);
+        free(workers);
+        return -1;
+    }
+
+    // Only the threads that were created can wait on the barrier, so it's initialized once they all were.
+    shared.start.store(0);
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].shared = &shared;
+        workers[started].id = started;
+        if (pthread_create(&tids[started], NULL, contention_thread, &workers[started]) != 0) {
+            break;
+        }
+    }
+    int status = started == threads ? 0 : -1;
+    if (status == 0) {
+        pthread_barrier_init(&shared.barrier, NULL, threads);
+    }
+    shared.start.store(status == 0 ? 1 : -1, std::memory_order_release);
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    if (status == 0) {
+        // The threads start together, so the slowest one bounds the time of all the operations.
+        double latency = 0, slowest = 0;
+        for (int t = 0; t < threads; t++) {
+            latency += workers[t].measurement.access_time - workers[t].measurement.baseline;
+            if (workers[t].measurement.access_time > slowest) slowest = workers[t].measurement.access_time;
+        }
+        result->latency = latency / threads;
+        result->throughput = 1000 * threads / slowest;
+        pthread_barrier_destroy(&shared.barrier);
+    }
+
+    free(workers);
+    free(tids);
+    return status;
+}
@@ -0,0 +1,101 @@
+#ifndef ATOMICS_H
+#define ATOMICS_H
+
+#include "memory_latency.h"
+#include "allocation.h"
+
+
+/**
+ * The operations of the atomic suite, as the x86 instructions they compile to.
+ */
+enum atomic_op {
+    ATOMIC_LOAD,        // std::atomic::load, a plain mov
+    ATOMIC_STORE,       // std::atomic::store, a plain mov (xchg for seq_cst)
+    ATOMIC_XADD,        // std::atomic::fetch_add, lock xadd
+    ATOMIC_CMPXCHG,     // std::atomic::compare_exchange_strong, lock cmpxchg
+    ATOMIC_XCHG,        // std::atomic::exchange, xchg
+    ATOMIC_FENCE,       // a relaxed store followed by std::atomic_thread_fence (mfence for seq_cst)
+    ATOMIC_OP_COUNT
+};
+
+
+/**
+ * The number of variants of the suite: every operation with every memory order it accepts.
+ */
+int atomic_variant_count();
+
+
+/**
+ * Returns the name of the operation of a variant ('load', 'store', 'xadd', 'cmpxchg', 'xchg' or 'fence').
+ * @param variant - the variant, in [0, atomic_variant_count()).
+ * @return - the name of the operation.
+ */
+const char* atomic_variant_op_name(int variant);
+
+
+/**
+ * Returns the name of the memory order of a variant ('relaxed', 'acquire', 'release', 'acq_rel' or 'seq_cst').
+ * @param variant - the variant, in [0, atomic_variant_count()).
+ * @return - the name of the memory order.
+ */
+const char* atomic_variant_order_name(int variant);
+
+
+/**
+ * Used as the return type of the atomic measurements.
+ */
+struct atomic_result {
+    double latency;     // the average time (ns) of one operation over its baseline loop, averaged over the threads
+    double throughput;  // the operations of all the threads per microsecond (millions per second)
+};
+
+
+/**
+ * Measures a variant on one thread, over the cache lines of a buffer of the given size, visited in a pseudo-random
+ * order (see scramble_pow2). The line of every operation depends on the result of the previous one, so a load or
+ * read-modify-write can not start before the previous one completed. A single line stays in L1, while a buffer
+ * larger than a cache level makes most operations miss it.
+ * @param variant - the variant, in [0, atomic_variant_count()).
+ * @param repeat - the number of operations to average on.
+ * @param bytes - the size of the buffer in bytes, rounded down to a power of two number of lines.
+ * @param mem_node - the NUMA node to bind the buffer to, or -1 for first-touch placement.
+ * @param backing - the pages backing the buffer.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param result - filled with the latency and throughput of the variant.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_atomic_latency(int variant, uint64_t repeat, uint64_t bytes, int mem_node, enum page_backing backing,
+                           uint64_t zero, struct atomic_result* result);
+
+
+/**
+ * Measures a variant on lines owned by another core: a thread pinned to owner_cpu writes a set of lines, then the
+ * calling thread, pinned to cpu, runs the variant once on every line while they are still modified in the owner's
+ * cache, and the two alternate until repeat operations were made. Only the passes of the calling thread are timed.
+ * @param variant - the variant, in [0, atomic_variant_count()).
+ * @param repeat - the number of operations to average on.
+ * @param cpu - the CPU of the calling thread.
+ * @param owner_cpu - the CPU of the thread that owns the lines.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param result - filled with the latency and throughput of the variant.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_atomic_remote(int variant, uint64_t repeat, int cpu, int owner_cpu, uint64_t zero,
+                          struct atomic_result* result);
+
+
+/**
+ * Measures a variant under contention: 'threads' threads, each pinned to its own CPU, run it on the same cache line
+ * at the same time.
+ * @param variant - the variant, in [0, atomic_variant_count()).
+ * @param repeat - the number of operations of every thread.
+ * @param threads - the number of threads.
+ * @param cpu_node - the NUMA node whose CPUs run the threads, or -1 for any allowed CPU.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param result - filled with the latency and throughput of the variant.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_atomic_contention(int variant, uint64_t repeat, int threads, int cpu_node, uint64_t zero,
+                              struct atomic_result* result);
+
+#endif
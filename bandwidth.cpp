@@ -0,0 +1,167 @@
+#include "memory_latency.h"
+#include "bandwidth.h"
+#include "allocation.h"
+#include "topology.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <atomic>
+
+#define STREAM_SCALAR 3.0
+
+enum stream_kernel { KERNEL_COPY, KERNEL_SCALE, KERNEL_ADD, KERNEL_TRIAD, KERNEL_COUNT };
+
+/**
+ * The state shared by all the threads of one bandwidth measurement.
+ */
+struct bandwidth_shared {
+    double* a;
+    double* b;
+    double* c;
+    uint64_t elements;
+    uint64_t passes;
+    int threads;
+    int cpu_node;
+    pthread_barrier_t barrier;
+    std::atomic<int> start;         // 0 while the threads are created, then 1 to run or -1 to quit
+    double elapsed_ns[KERNEL_COUNT];
+};
+
+/**
+ * The arguments of a single bandwidth thread.
+ */
+struct bandwidth_worker {
+    struct bandwidth_shared* shared;
+    int id;
+};
+
+/**
+ * Runs one kernel over the chunk [begin, end) of the arrays, 'passes' times.
+ */
+static void run_kernel(enum stream_kernel kernel, double* a, double* b, double* c, uint64_t begin, uint64_t end,
+                       uint64_t passes)
+{
+    const double s = STREAM_SCALAR;
+    for (uint64_t p = 0; p < passes; p++) {
+        switch (kernel) {
+            case KERNEL_COPY:
+                for (uint64_t i = begin; i < end; i++) c[i] = a[i];
+                break;
+            case KERNEL_SCALE:
+                for (uint64_t i = begin; i < end; i++) b[i] = s * c[i];
+                break;
+            case KERNEL_ADD:
+                for (uint64_t i = begin; i < end; i++) c[i] = a[i] + b[i];
+                break;
+            case KERNEL_TRIAD:
+                for (uint64_t i = begin; i < end; i++) a[i] = b[i] + s * c[i];
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * The body of a bandwidth thread: pins itself, first-touches its chunk and runs all the kernels in lockstep with the
+ * other threads. Thread 0 takes the timestamps.
+ */
+static void* bandwidth_thread(void* arg)
+{
+    struct bandwidth_worker* worker = (struct bandwidth_worker*)arg;
+    struct bandwidth_shared* shared = worker->shared;
+    pin_current_thread(numa_node_cpu(shared->cpu_node, worker->id));
+    while (shared->start.load(std::memory_order_acquire) == 0) {
+    }
+    if (shared->start.load(std::memory_order_relaxed) < 0) {
+        return NULL;
+    }
+
+    uint64_t begin = shared->elements * worker->id / shared->threads;
+    uint64_t end = shared->elements * (worker->id + 1) / shared->threads;
+    for (uint64_t i = begin; i < end; i++) {
+        shared->a[i] = 1.0;
+        shared->b[i] = 2.0;
+        shared->c[i] = 0.0;
+    }
+
+    for (int k = 0; k < KERNEL_COUNT; k++) {
+        uint64_t t0 = 0;
+        pthread_barrier_wait(&shared->barrier);
+        if (worker->id == 0) t0 = timer_now();
+        run_kernel((enum stream_kernel)k, shared->a, shared->b, shared->c, begin, end, shared->passes);
+        pthread_barrier_wait(&shared->barrier);
+        if (worker->id == 0) {
+            shared->elapsed_ns[k] = timer_ticks_to_ns(timer_now() - t0);
+        }
+    }
+    return NULL;
+}
+
+int measure_bandwidth(uint64_t repeat, uint64_t size_bytes, int threads, int mem_node, int cpu_node,
+                      struct bandwidth_result* result)
+{
+    struct bandwidth_shared shared;
+    shared.elements = size_bytes / (3 * sizeof(double));
+    if (shared.elements == 0) shared.elements = 1;  // Ensure at least one element
+    shared.passes = (repeat + shared.elements - 1) / shared.elements;
+    if (shared.passes == 0) shared.passes = 1;
+    shared.threads = threads;
+    shared.cpu_node = cpu_node;
+    uint64_t array_bytes = shared.elements * sizeof(double);
+
+    shared.a = (double*)alloc_array(array_bytes, mem_node, BACKING_DEFAULT);
+    shared.b = (double*)alloc_array(array_bytes, mem_node, BACKING_DEFAULT);
+    shared.c = (double*)alloc_array(array_bytes, mem_node, BACKING_DEFAULT);
+    if (shared.a == NULL || shared.b == NULL || shared.c == NULL) {
+        free_array(shared.a, array_bytes, BACKING_DEFAULT);
+        free_array(shared.b, array_bytes, BACKING_DEFAULT);
+        free_array(shared.c, array_bytes, BACKING_DEFAULT);
+        return -1;
+    }
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    struct bandwidth_worker* workers = (struct bandwidth_worker*)malloc(threads * sizeof(struct bandwidth_worker));
+    if (tids == NULL || workers == NULL) {
+        free(tids);
+        free(workers);
+        free_array(shared.a, array_bytes, BACKING_DEFAULT);
+        free_array(shared.b, array_bytes, BACKING_DEFAULT);
+        free_array(shared.c, array_bytes, BACKING_DEFAULT);
+        return -1;
+    }
+
+    // The threads wait for the start flag, so the barrier is only sized once it is known how many of them started.
+    shared.start.store(0);
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].shared = &shared;
+        workers[started].id = started;
+        if (pthread_create(&tids[started], NULL, bandwidth_thread, &workers[started]) != 0) {
+            break;
+        }
+    }
+    int status = started == threads ? 0 : -1;
+    if (status == 0) {
+        pthread_barrier_init(&shared.barrier, NULL, threads);
+    }
+    shared.start.store(status == 0 ? 1 : -1, std::memory_order_release);
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    if (status == 0) {
+        // Bytes moved per element: copy and scale read one array and write one, add and triad read two.
+        double elements = (double)shared.elements * shared.passes;
+        result->copy = 2 * sizeof(double) * elements / shared.elapsed_ns[KERNEL_COPY];
+        result->scale = 2 * sizeof(double) * elements / shared.elapsed_ns[KERNEL_SCALE];
+        result->add = 3 * sizeof(double) * elements / shared.elapsed_ns[KERNEL_ADD];
+        result->triad = 3 * sizeof(double) * elements / shared.elapsed_ns[KERNEL_TRIAD];
+        pthread_barrier_destroy(&shared.barrier);
+    }
+
+    free(workers);
+    free(tids);
+    free_array(shared.a, array_bytes, BACKING_DEFAULT);
+    free_array(shared.b, array_bytes, BACKING_DEFAULT);
+    free_array(shared.c, array_bytes, BACKING_DEFAULT);
+    return status;
+}
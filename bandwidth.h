@@ -0,0 +1,35 @@
+#ifndef BANDWIDTH_H
+#define BANDWIDTH_H
+
+#include "memory_latency.h"
+
+
+/**
+ * Used as the return type for 'measure_bandwidth'. Every field is the sustained bandwidth (GB/s) of one
+ * STREAM-style kernel.
+ */
+struct bandwidth_result {
+    double copy;    // c[i] = a[i]
+    double scale;   // b[i] = s * c[i]
+    double add;     // c[i] = a[i] + b[i]
+    double triad;   // a[i] = b[i] + s * c[i]
+};
+
+
+/**
+ * Measures the sustained memory bandwidth of the STREAM copy, scale, add and triad kernels.
+ * The working set is split into three equal arrays, and every array is split into contiguous chunks, one per thread.
+ * Each thread is pinned to its own CPU and first-touches its own chunks, unless the arrays are bound to a NUMA node.
+ * @param repeat - the minimal number of elements every kernel should process, the kernels are run over the whole
+ *                 working set as many times as needed to reach it.
+ * @param size_bytes - the total size in bytes of the three arrays.
+ * @param threads - the number of threads to run the kernels on.
+ * @param mem_node - the NUMA node to bind the arrays to, or -1 for first-touch placement.
+ * @param cpu_node - the NUMA node whose CPUs run the threads, or -1 for any allowed CPU.
+ * @param result - filled with the measured bandwidths.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_bandwidth(uint64_t repeat, uint64_t size_bytes, int threads, int mem_node, int cpu_node,
+                      struct bandwidth_result* result);
+
+#endif
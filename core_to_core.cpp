@@ -0,0 +1,76 @@
+#include "memory_latency.h"
+#include "core_to_core.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <atomic>
+
+/**
+ * The cache line the two threads pass between them. The counter is alone in its line so nothing else is transferred.
+ */
+struct alignas(64) ping_pong_line {
+    std::atomic<uint64_t> counter;
+    char padding[64 - sizeof(std::atomic<uint64_t>)];
+};
+
+/**
+ * The arguments of the responding thread.
+ */
+struct ping_pong_args {
+    struct ping_pong_line* line;
+    uint64_t repeat;
+    int cpu;
+};
+
+/**
+ * The body of the responding thread: waits for every odd value of the counter and answers with the next even one.
+ */
+static void* ping_pong_responder(void* arg)
+{
+    struct ping_pong_args* args = (struct ping_pong_args*)arg;
+    pin_current_thread(args->cpu);
+    std::atomic<uint64_t>& counter = args->line->counter;
+    for (uint64_t i = 0; i < args->repeat; i++) {
+        uint64_t expected = 2 * i + 1;
+        while (counter.load(std::memory_order_acquire) != expected) {
+        }
+        counter.store(expected + 1, std::memory_order_release);
+    }
+    return NULL;
+}
+
+double measure_core_to_core_latency(uint64_t repeat, int cpu_a, int cpu_b)
+{
+    struct ping_pong_line line;
+    line.counter.store(0);
+    struct ping_pong_args args;
+    args.line = &line;
+    args.repeat = repeat;
+    args.cpu = cpu_b;
+
+    if (pin_current_thread(cpu_a) != 0) {
+        return -1;
+    }
+    pthread_t responder;
+    if (pthread_create(&responder, NULL, ping_pong_responder, &args) != 0) {
+        return -1;
+    }
+
+    // Warm up: the first round trip also covers the creation and pinning of the responder.
+    line.counter.store(1, std::memory_order_release);
+    while (line.counter.load(std::memory_order_acquire) != 2) {
+    }
+
+    uint64_t t0 = timer_now();
+    for (uint64_t i = 1; i < repeat; i++) {
+        line.counter.store(2 * i + 1, std::memory_order_release);
+        while (line.counter.load(std::memory_order_acquire) != 2 * i + 2) {
+        }
+    }
+    uint64_t t1 = timer_now();
+    pthread_join(responder, NULL);
+
+    if (repeat < 2) {
+        return 0;
+    }
+    return timer_ticks_to_ns(t1 - t0) / (repeat - 1) / 2;
+}
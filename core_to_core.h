@@ -0,0 +1,18 @@
+#ifndef CORE_TO_CORE_H
+#define CORE_TO_CORE_H
+
+#include "memory_latency.h"
+
+
+/**
+ * Measures the average latency of moving a cache line between two CPUs. The calling thread is pinned to cpu_a and a
+ * second thread to cpu_b, and the two ping-pong a counter stored alone in one cache line: each side waits until the
+ * other side wrote the counter, then writes it back.
+ * @param repeat - the number of round trips to average on.
+ * @param cpu_a - the CPU of the calling thread.
+ * @param cpu_b - the CPU of the responding thread.
+ * @return - the average one-way transfer latency (ns), i.e. half a round trip, or a negative value on failure.
+ */
+double measure_core_to_core_latency(uint64_t repeat, int cpu_a, int cpu_b);
+
+#endif
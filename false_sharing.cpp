@@ -0,0 +1,141 @@
+#include "memory_latency.h"
+#include "false_sharing.h"
+#include "allocation.h"
+#include "topology.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <atomic>
+
+/**
+ * The state shared by all the threads of one false sharing measurement.
+ */
+struct sharing_shared {
+    char* buffer;
+    uint64_t stride;
+    uint64_t repeat;
+    int cpu_node;
+    pthread_barrier_t barrier;
+    std::atomic<int> go;            // 0 while the threads are created, then 1 to run or -1 to quit
+    uint64_t start;
+    uint64_t end;
+};
+
+/**
+ * The arguments and result of a single updating thread.
+ */
+struct sharing_worker {
+    struct sharing_shared* shared;
+    int id;
+    double elapsed_ns;
+};
+
+/**
+ * The body of an updating thread: pins itself, then increments its variable in lockstep with the other threads.
+ * Thread 0 takes the timestamps of the whole run.
+ */
+static void* sharing_thread(void* arg)
+{
+    struct sharing_worker* worker = (struct sharing_worker*)arg;
+    struct sharing_shared* shared = worker->shared;
+    pin_current_thread(numa_node_cpu(shared->cpu_node, worker->id));
+    volatile uint64_t* variable = (volatile uint64_t*)(shared->buffer + worker->id * shared->stride);
+    while (shared->go.load(std::memory_order_acquire) == 0) {
+    }
+    if (shared->go.load(std::memory_order_relaxed) < 0) {
+        return NULL;
+    }
+
+    pthread_barrier_wait(&shared->barrier);
+    if (worker->id == 0) shared->start = timer_now();
+    uint64_t t0 = timer_now();
+    for (uint64_t i = 0; i < shared->repeat; i++) {
+        *variable = *variable + 1;
+    }
+    uint64_t t1 = timer_now();
+    pthread_barrier_wait(&shared->barrier);
+    if (worker->id == 0) shared->end = timer_now();
+
+    worker->elapsed_ns = timer_ticks_to_ns(t1 - t0);
+    return NULL;
+}
+
+const char* sharing_layout_name(enum sharing_layout layout)
+{
+    static const char* const NAMES[LAYOUT_COUNT] = {"same_line", "adjacent_lines", "separate_pairs",
+                                                    "separate_pages"};
+    return layout >= 0 && layout < LAYOUT_COUNT ? NAMES[layout] : "unknown";
+}
+
+uint64_t sharing_layout_stride(enum sharing_layout layout)
+{
+    switch (layout) {
+        case LAYOUT_SAME_LINE:
+            return sizeof(uint64_t);
+        case LAYOUT_ADJACENT_LINES:
+            return CACHE_LINE_SIZE;
+        case LAYOUT_SEPARATE_PAIRS:
+            return 2 * CACHE_LINE_SIZE;
+        case LAYOUT_SEPARATE_PAGES:
+        default:
+            return sysconf(_SC_PAGESIZE);
+    }
+}
+
+int measure_false_sharing(uint64_t repeat, int threads, uint64_t stride, int mem_node, int cpu_node,
+                          struct sharing_result* result)
+{
+    struct sharing_shared shared;
+    uint64_t bytes = threads * stride;
+    shared.buffer = (char*)alloc_array(bytes, mem_node, BACKING_DEFAULT);
+    if (shared.buffer == NULL) {
+        return -1;
+    }
+    prefault_array(shared.buffer, bytes, false);
+    shared.stride = stride;
+    shared.repeat = repeat;
+    shared.cpu_node = cpu_node;
+
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    struct sharing_worker* workers = (struct sharing_worker*)malloc(threads * sizeof(struct sharing_worker));
+    if (tids == NULL || workers == NULL) {
+        free(tids);
+        free(workers);
+        free_array(shared.buffer, bytes, BACKING_DEFAULT);
+        return -1;
+    }
+
+    // The barrier is sized for all the threads, so it's only initialized once they all started.
+    shared.go.store(0);
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].shared = &shared;
+        workers[started].id = started;
+        if (pthread_create(&tids[started], NULL, sharing_thread, &workers[started]) != 0) {
+            break;
+        }
+    }
+    int status = started == threads ? 0 : -1;
+    if (status == 0) {
+        pthread_barrier_init(&shared.barrier, NULL, threads);
+    }
+    shared.go.store(status == 0 ? 1 : -1, std::memory_order_release);
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    if (status == 0) {
+        double elapsed_ns = 0;
+        for (int t = 0; t < threads; t++) {
+            elapsed_ns += workers[t].elapsed_ns;
+        }
+        result->latency = elapsed_ns / threads / repeat;
+        result->throughput = (double)threads * repeat / timer_ticks_to_ns(shared.end - shared.start) * 1000;
+        pthread_barrier_destroy(&shared.barrier);
+    }
+
+    free(workers);
+    free(tids);
+    free_array(shared.buffer, bytes, BACKING_DEFAULT);
+    return status;
+}
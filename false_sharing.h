@@ -0,0 +1,60 @@
+#ifndef FALSE_SHARING_H
+#define FALSE_SHARING_H
+
+#include "memory_latency.h"
+
+
+/**
+ * The layouts of the per-thread variables of the false sharing benchmark, from the most to the least shared.
+ */
+enum sharing_layout {
+    LAYOUT_SAME_LINE,       // 8 bytes apart: up to 8 threads update one cache line
+    LAYOUT_ADJACENT_LINES,  // 64 bytes apart: a line per thread, neighbours share a 128-byte spatial prefetch pair
+    LAYOUT_SEPARATE_PAIRS,  // 128 bytes apart: a 128-byte pair of lines per thread
+    LAYOUT_SEPARATE_PAGES,  // a page apart
+    LAYOUT_COUNT
+};
+
+
+/**
+ * Used as the return type for 'measure_false_sharing'.
+ */
+struct sharing_result {
+    double throughput;  // the updates of all the threads per microsecond (millions per second)
+    double latency;     // the average time (ns) of one update, over all the threads
+};
+
+
+/**
+ * Returns the name of a layout ('same_line', 'adjacent_lines', 'separate_pairs' or 'separate_pages').
+ * @param layout - the layout to name.
+ * @return - the name of the layout.
+ */
+const char* sharing_layout_name(enum sharing_layout layout);
+
+
+/**
+ * Returns the distance between the variables of consecutive threads in a layout.
+ * @param layout - the layout.
+ * @return - the distance in bytes.
+ */
+uint64_t sharing_layout_stride(enum sharing_layout layout);
+
+
+/**
+ * Measures the cost of false sharing: every thread is pinned to its own CPU and increments its own 8-byte variable
+ * 'repeat' times, with plain loads and stores as a per-thread counter would. The variable of thread t is at byte
+ * offset t * stride of a page-aligned buffer, so a stride below the cache line size puts several threads' variables
+ * in one line, which then moves between their cores on every update.
+ * @param repeat - the number of updates of every thread.
+ * @param threads - the number of threads.
+ * @param stride - the distance in bytes between the variables of consecutive threads, a multiple of 8.
+ * @param mem_node - the NUMA node to bind the buffer to, or -1 for first-touch placement.
+ * @param cpu_node - the NUMA node whose CPUs run the threads, or -1 for any allowed CPU.
+ * @param result - filled with the measured throughput and latency.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_false_sharing(uint64_t repeat, int threads, uint64_t stride, int mem_node, int cpu_node,
+                          struct sharing_result* result);
+
+#endif
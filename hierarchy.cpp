@@ -0,0 +1,93 @@
+#include "hierarchy.h"
+#include <algorithm>
+#include <math.h>
+#include <vector>
+
+#define SEGMENT_PENALTY 0.2
+#define MIN_PLATEAU_POINTS 3
+#define LEVEL_RATIO 1.5
+#define MIN_LATENCY_NS 0.5
+
+/**
+ * Returns the median of latencies[first..last].
+ */
+static double median_latency(const double* latencies, int first, int last)
+{
+    std::vector<double> values(latencies + first, latencies + last + 1);
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+/**
+ * Splits the curve into the piecewise-constant segments of log latency that minimize the squared error plus
+ * SEGMENT_PENALTY per segment (optimal partitioning by dynamic programming).
+ * @return - the index of the first point of every segment, in order.
+ */
+static std::vector<int> segment_curve(const double* latencies, int count)
+{
+    // Prefix sums of the log latencies and their squares give the error of any segment in O(1).
+    std::vector<double> sum(count + 1, 0), squares(count + 1, 0);
+    for (int i = 0; i < count; i++) {
+        double y = log(std::max(latencies[i], MIN_LATENCY_NS));
+        sum[i + 1] = sum[i] + y;
+        squares[i + 1] = squares[i] + y * y;
+    }
+
+    std::vector<double> best(count + 1, 0);
+    std::vector<int> first(count + 1, 0);
+    for (int end = 1; end <= count; end++) {
+        best[end] = INFINITY;
+        for (int start = 0; start < end; start++) {
+            double n = end - start;
+            double s = sum[end] - sum[start];
+            double error = squares[end] - squares[start] - s * s / n;
+            double cost = best[start] + error + SEGMENT_PENALTY;
+            if (cost < best[end]) {
+                best[end] = cost;
+                first[end] = start;
+            }
+        }
+    }
+
+    std::vector<int> starts;
+    for (int end = count; end > 0; end = first[end]) {
+        starts.push_back(first[end]);
+    }
+    std::reverse(starts.begin(), starts.end());
+    return starts;
+}
+
+int detect_cache_levels(const uint64_t* sizes, const double* latencies, int count, struct detected_level* levels,
+                        int max_levels)
+{
+    std::vector<int> starts = segment_curve(latencies, count);
+    int detected = 0;
+    int level_start = -1;
+    double level_latency = 0;
+    for (size_t s = 0; s < starts.size(); s++) {
+        int first = starts[s];
+        int last = s + 1 < starts.size() ? starts[s + 1] - 1 : count - 1;
+        if (last - first + 1 < MIN_PLATEAU_POINTS) {
+            continue;  // a transition between levels
+        }
+        double latency = median_latency(latencies, first, last);
+        if (detected > 0 && latency < level_latency * LEVEL_RATIO) {
+            // Still the same level: extend it
+            levels[detected - 1].size = sizes[last];
+            levels[detected - 1].latency = median_latency(latencies, level_start, last);
+            levels[detected - 1].points += last - first + 1;
+            continue;
+        }
+        if (detected == max_levels) {
+            break;
+        }
+        level_start = first;
+        level_latency = latency;
+        levels[detected].size = sizes[last];
+        levels[detected].latency = latency;
+        levels[detected].points = last - first + 1;
+        detected++;
+    }
+    return detected;
+}
@@ -0,0 +1,33 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <stdint.h>
+
+
+/**
+ * One plateau of a latency curve: a level of the memory hierarchy.
+ */
+struct detected_level {
+    uint64_t size;          // the largest working set (bytes) still on the plateau, i.e. the inferred capacity
+    double latency;         // the median latency (ns) of the plateau
+    int points;             // the number of measured sizes on the plateau
+};
+
+
+/**
+ * Detects the plateaus of a latency-vs-size curve. The curve is first split into the piecewise-constant segments
+ * (in log latency) that fit it best, with a penalty of SEGMENT_PENALTY per segment. Segments of fewer than
+ * MIN_PLATEAU_POINTS sizes are transitions between levels. Consecutive plateaus whose latencies are within
+ * LEVEL_RATIO of each other are merged into one level.
+ * The last level is usually the main memory, its size is just the largest size measured.
+ * @param sizes - the working set sizes (bytes), increasing.
+ * @param latencies - the latency (ns) measured for every size.
+ * @param count - the number of measured sizes.
+ * @param levels - filled with the detected levels, from the fastest.
+ * @param max_levels - the length of levels.
+ * @return - the number of detected levels.
+ */
+int detect_cache_levels(const uint64_t* sizes, const double* latencies, int count, struct detected_level* levels,
+                        int max_levels);
+
+#endif
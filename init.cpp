@@ -0,0 +1,76 @@
+#include "memory_latency.h"
+#include "init.h"
+#include "prng.h"
+#include "topology.h"
+#include "affinity.h"
+#include <pthread.h>
+
+/**
+ * The arguments of a single initialisation thread.
+ */
+struct init_worker {
+    array_element_t* arr;
+    uint64_t begin;
+    uint64_t end;
+    uint64_t seed;
+    int cpu;
+};
+
+/**
+ * Fills the chunk [begin, end) of the array. Every element only depends on its index, so the loop has no carried
+ * dependency and the compiler is free to vectorise it.
+ */
+static void fill_chunk(array_element_t* arr, uint64_t begin, uint64_t end, uint64_t seed)
+{
+    for (uint64_t i = begin; i < end; i++) {
+        arr[i] = splitmix64_at(seed, i);
+    }
+}
+
+/**
+ * The body of an initialisation thread: pins itself, then fills (and so first-touches) its own chunk.
+ */
+static void* init_thread(void* arg)
+{
+    struct init_worker* worker = (struct init_worker*)arg;
+    pin_current_thread(worker->cpu);
+    fill_chunk(worker->arr, worker->begin, worker->end, worker->seed);
+    return NULL;
+}
+
+int fill_random_parallel(array_element_t* arr, uint64_t arr_size, uint64_t seed, int threads, int cpu_node)
+{
+    uint64_t max_threads = arr_size / INIT_MIN_ELEMENTS_PER_THREAD;
+    if ((uint64_t)threads > max_threads) threads = (int)max_threads;
+    if (threads <= 1) {
+        fill_chunk(arr, 0, arr_size, seed);
+        return 0;
+    }
+
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    struct init_worker* workers = (struct init_worker*)malloc(threads * sizeof(struct init_worker));
+    if (tids == NULL || workers == NULL) {
+        free(tids);
+        free(workers);
+        return -1;
+    }
+
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].arr = arr;
+        workers[started].begin = arr_size * started / threads;
+        workers[started].end = arr_size * (started + 1) / threads;
+        workers[started].seed = seed;
+        workers[started].cpu = numa_node_cpu(cpu_node, started);
+        if (pthread_create(&tids[started], NULL, init_thread, &workers[started]) != 0) {
+            break;
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+
+    free(tids);
+    free(workers);
+    return started == threads ? 0 : -1;
+}
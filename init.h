@@ -0,0 +1,24 @@
+#ifndef INIT_H
+#define INIT_H
+
+#include "memory_latency.h"
+
+// Below this many elements per thread, starting the threads costs more than filling the array serially.
+#define INIT_MIN_ELEMENTS_PER_THREAD (1ull << 18)
+
+
+/**
+ * Fills an array with pseudo-random values using several threads. Element i is set to splitmix64_at(seed, i), so the
+ * content only depends on the seed, and not on the number of threads. The array is split into contiguous chunks, one
+ * per thread, and every thread is pinned to its own CPU and first-touches its own chunk. Small arrays are filled by
+ * the calling thread alone.
+ * @param arr - an allocated array to fill.
+ * @param arr_size - the length of the array arr.
+ * @param seed - the seed of the pseudo-random sequence.
+ * @param threads - the maximal number of threads to fill the array with.
+ * @param cpu_node - the NUMA node whose CPUs run the threads, or -1 for any allowed CPU.
+ * @return 0 on success, -1 on failure (the array is left partially filled).
+ */
+int fill_random_parallel(array_element_t* arr, uint64_t arr_size, uint64_t seed, int threads, int cpu_node);
+
+#endif
@@ -0,0 +1,134 @@
+#include "memory_latency.h"
+#include "kernel_family.h"
+#include "prng.h"
+
+const int FAMILY_ELEMENT_SIZES[FAMILY_ELEMENT_SIZE_COUNT] = {4, 8, 16, 64};
+const int FAMILY_UNROLLS[FAMILY_UNROLL_COUNT] = {1, 2, 4, 8};
+
+/**
+ * A record of BYTES bytes, made of 8 byte words and aligned to its size (so a 64 byte record is one cache line).
+ */
+template <int BYTES>
+struct alignas(BYTES) record {
+    uint64_t words[BYTES / sizeof(uint64_t)];
+};
+
+/**
+ * The 4 byte record, smaller than a word.
+ */
+template <>
+struct alignas(4) record<4> {
+    uint32_t words[1];
+};
+
+/**
+ * Reads every word of a record, and folds them into one value.
+ */
+template <int BYTES>
+static inline uint64_t read_record(const record<BYTES>* rec)
+{
+    uint64_t value = 0;
+    for (unsigned w = 0; w < sizeof(rec->words) / sizeof(rec->words[0]); w++) value ^= rec->words[w];
+    return value;
+}
+
+/**
+ * Advances the index generator: pseudo-randomly (using a Galois LFSR) like measure_latency, or by one like
+ * measure_sequential_latency.
+ */
+template <enum access_pattern PATTERN>
+static inline uint64_t advance(uint64_t rnd)
+{
+    return PATTERN == PATTERN_SEQUENTIAL ? rnd + 1 : lfsr_advance(rnd);
+}
+
+/**
+ * The kernel of one record size, unroll factor and pattern. The unrolled loop has a constant trip count, so the
+ * compiler flattens it, and every parameter is resolved at compile time.
+ */
+template <int BYTES, int UNROLL, enum access_pattern PATTERN>
+static struct measurement family_kernel(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    const record<BYTES>* records = (const record<BYTES>*)arr;
+    uint64_t count = arr_size * sizeof(array_element_t) / BYTES;
+    repeat = count > repeat ? count:repeat; // Make sure repeat >= count
+    uint64_t rounds = (repeat + UNROLL - 1) / UNROLL;
+
+    // Baseline measurement:
+    uint64_t t0 = timer_now();
+    uint64_t rnd = 12345;
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        for (int u = 0; u < UNROLL; u++)
+        {
+            uint64_t index = rnd % count;
+            rnd ^= index & zero;
+            rnd = advance<PATTERN>(rnd);
+        }
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    rnd = (rnd & zero) ^ 12345;
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        for (int u = 0; u < UNROLL; u++)
+        {
+            uint64_t index = rnd % count;
+            rnd ^= read_record(&records[index]) & zero;
+            rnd = advance<PATTERN>(rnd);
+        }
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(rounds * UNROLL, result.counters);
+
+    result.baseline = timer_ticks_to_ns(t1 - t0) / (rounds * UNROLL);
+    result.access_time = timer_ticks_to_ns(t3 - t2) / (rounds * UNROLL);
+    result.rnd = rnd;
+    return result;
+}
+
+/**
+ * The instantiations, indexed like FAMILY_ELEMENT_SIZES, FAMILY_UNROLLS and enum access_pattern.
+ */
+static const latency_kernel_t FAMILY_KERNELS[FAMILY_ELEMENT_SIZE_COUNT][FAMILY_UNROLL_COUNT][PATTERN_COUNT] = {
+    {
+        {family_kernel<4, 1, PATTERN_RANDOM>, family_kernel<4, 1, PATTERN_SEQUENTIAL>},
+        {family_kernel<4, 2, PATTERN_RANDOM>, family_kernel<4, 2, PATTERN_SEQUENTIAL>},
+        {family_kernel<4, 4, PATTERN_RANDOM>, family_kernel<4, 4, PATTERN_SEQUENTIAL>},
+        {family_kernel<4, 8, PATTERN_RANDOM>, family_kernel<4, 8, PATTERN_SEQUENTIAL>},
+    },
+    {
+        {family_kernel<8, 1, PATTERN_RANDOM>, family_kernel<8, 1, PATTERN_SEQUENTIAL>},
+        {family_kernel<8, 2, PATTERN_RANDOM>, family_kernel<8, 2, PATTERN_SEQUENTIAL>},
+        {family_kernel<8, 4, PATTERN_RANDOM>, family_kernel<8, 4, PATTERN_SEQUENTIAL>},
+        {family_kernel<8, 8, PATTERN_RANDOM>, family_kernel<8, 8, PATTERN_SEQUENTIAL>},
+    },
+    {
+        {family_kernel<16, 1, PATTERN_RANDOM>, family_kernel<16, 1, PATTERN_SEQUENTIAL>},
+        {family_kernel<16, 2, PATTERN_RANDOM>, family_kernel<16, 2, PATTERN_SEQUENTIAL>},
+        {family_kernel<16, 4, PATTERN_RANDOM>, family_kernel<16, 4, PATTERN_SEQUENTIAL>},
+        {family_kernel<16, 8, PATTERN_RANDOM>, family_kernel<16, 8, PATTERN_SEQUENTIAL>},
+    },
+    {
+        {family_kernel<64, 1, PATTERN_RANDOM>, family_kernel<64, 1, PATTERN_SEQUENTIAL>},
+        {family_kernel<64, 2, PATTERN_RANDOM>, family_kernel<64, 2, PATTERN_SEQUENTIAL>},
+        {family_kernel<64, 4, PATTERN_RANDOM>, family_kernel<64, 4, PATTERN_SEQUENTIAL>},
+        {family_kernel<64, 8, PATTERN_RANDOM>, family_kernel<64, 8, PATTERN_SEQUENTIAL>},
+    },
+};
+
+latency_kernel_t select_family_kernel(int element_size, int unroll, enum access_pattern pattern)
+{
+    for (int e = 0; e < FAMILY_ELEMENT_SIZE_COUNT; e++) {
+        for (int u = 0; u < FAMILY_UNROLL_COUNT; u++) {
+            if (FAMILY_ELEMENT_SIZES[e] == element_size && FAMILY_UNROLLS[u] == unroll && pattern < PATTERN_COUNT) {
+                return FAMILY_KERNELS[e][u][pattern];
+            }
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,40 @@
+#ifndef KERNEL_FAMILY_H
+#define KERNEL_FAMILY_H
+
+#include "memory_latency.h"
+
+#define FAMILY_ELEMENT_SIZE_COUNT 4
+#define FAMILY_UNROLL_COUNT 4
+
+
+/**
+ * The index sequences of the kernel family, those of measure_latency and measure_sequential_latency.
+ */
+enum access_pattern {
+    PATTERN_RANDOM,
+    PATTERN_SEQUENTIAL,
+    PATTERN_COUNT
+};
+
+
+/**
+ * The record sizes (bytes) and unroll factors the kernel family is instantiated for.
+ */
+extern const int FAMILY_ELEMENT_SIZES[FAMILY_ELEMENT_SIZE_COUNT];
+extern const int FAMILY_UNROLLS[FAMILY_UNROLL_COUNT];
+
+
+/**
+ * Returns the instantiation of the kernel family for a record size, unroll factor and access pattern.
+ * The kernels view the array as records of element_size bytes (a 4 or 8 byte integer, or a struct of 8 byte words),
+ * access one record per iteration and read all of it, and run 'unroll' accesses per loop iteration. Apart from that,
+ * they measure the same way as measure_latency and measure_sequential_latency: arr_size is still the length of the
+ * array in array_element_t, and the results are per record access. Note that the array must hold at least one record.
+ * @param element_size - the size of a record in bytes, one of FAMILY_ELEMENT_SIZES.
+ * @param unroll - the number of accesses per loop iteration, one of FAMILY_UNROLLS.
+ * @param pattern - the access pattern.
+ * @return - the kernel, or NULL if the family isn't instantiated for these parameters.
+ */
+latency_kernel_t select_family_kernel(int element_size, int unroll, enum access_pattern pattern);
+
+#endif
@@ -0,0 +1,86 @@
+#include "memory_latency.h"
+#include "latency_histogram.h"
+#include <string.h>
+
+#define TIMER_OVERHEAD_SAMPLES 1000
+
+/**
+ * Returns the bucket of a value.
+ */
+static inline int bucket_of(uint64_t value)
+{
+    if (value < HISTOGRAM_SUB_BUCKETS) {
+        return (int)value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int shift = exponent - HISTOGRAM_SUB_BUCKET_BITS;
+    return (shift + 1) * HISTOGRAM_SUB_BUCKETS + (int)((value >> shift) - HISTOGRAM_SUB_BUCKETS);
+}
+
+/**
+ * Returns the middle of the range of values counted in a bucket.
+ */
+static double bucket_value(int bucket)
+{
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+    uint64_t low = (uint64_t)(bucket % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS) << shift;
+    return low + ((1ULL << shift) - 1) / 2.0;
+}
+
+void histogram_reset(struct latency_histogram* histogram)
+{
+    memset(histogram, 0, sizeof(*histogram));
+}
+
+double histogram_quantile(const struct latency_histogram* histogram, double q)
+{
+    if (histogram->total == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(q * histogram->total);
+    if (rank >= histogram->total) rank = histogram->total - 1;
+    uint64_t seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+        seen += histogram->counts[b];
+        if (seen > rank) {
+            return bucket_value(b);
+        }
+    }
+    return histogram->max;
+}
+
+uint64_t measure_latency_histogram(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                   uint64_t batch, struct latency_histogram* histogram)
+{
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+    histogram_reset(histogram);
+
+    // The cheapest back-to-back timer reading is the overhead included in every batch.
+    uint64_t overhead = UINT64_MAX;
+    for (int i = 0; i < TIMER_OVERHEAD_SAMPLES; i++) {
+        uint64_t t0 = timer_now();
+        uint64_t t1 = timer_now();
+        if (t1 - t0 < overhead) overhead = t1 - t0;
+    }
+
+    register uint64_t index = 0;
+    for (uint64_t done = 0; done < repeat; done += batch)
+    {
+        uint64_t t0 = timer_now();
+        for (register uint64_t i = 0; i < batch; i++)
+        {
+            index = arr[index];
+        }
+        uint64_t t1 = timer_now();
+
+        uint64_t ticks = t1 - t0 > overhead ? t1 - t0 - overhead : 0;
+        histogram->counts[bucket_of(ticks)]++;
+        histogram->total++;
+        if (ticks > histogram->max) histogram->max = ticks;
+        index ^= ticks & zero;
+    }
+    return index;
+}
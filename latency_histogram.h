@@ -0,0 +1,54 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include "memory_latency.h"
+
+#define HISTOGRAM_SUB_BUCKET_BITS 5
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_BUCKETS ((64 - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+
+/**
+ * A log-linear (HDR-style) histogram of timer ticks: values below HISTOGRAM_SUB_BUCKETS are counted exactly, and
+ * every power of two above is split into HISTOGRAM_SUB_BUCKETS linear buckets, so the relative error of a recorded
+ * value is below 1/HISTOGRAM_SUB_BUCKETS.
+ */
+struct latency_histogram {
+    uint64_t counts[HISTOGRAM_BUCKETS];
+    uint64_t total;
+    uint64_t max;
+};
+
+
+/**
+ * Empties a histogram.
+ * @param histogram - the histogram to empty.
+ */
+void histogram_reset(struct latency_histogram* histogram);
+
+
+/**
+ * Returns the value below which a given fraction of the recorded values lie, as the middle of its bucket.
+ * @param histogram - the histogram to query.
+ * @param q - the quantile, in [0, 1].
+ * @return - the value of the quantile, or 0 if the histogram is empty.
+ */
+double histogram_quantile(const struct latency_histogram* histogram, double q);
+
+
+/**
+ * Times batches of 'batch' dependent loads over the cycle stored in the array, and records the time of every batch
+ * (minus the overhead of reading the timer) in the histogram. Dividing a quantile by 'batch' gives the per-access
+ * latency in timer ticks.
+ * @param repeat - the number of accesses to sample (at least arr_size).
+ * @param arr - an array filled by build_random_cycle.
+ * @param arr_size - the length of the array arr.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param batch - the number of dependent accesses timed together.
+ * @param histogram - filled with the batch times, in timer ticks.
+ * @return - the last index visited, returned to prevent compiler optimizations.
+ */
+uint64_t measure_latency_histogram(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                   uint64_t batch, struct latency_histogram* histogram);
+
+#endif
@@ -0,0 +1,139 @@
+#include "memory_latency.h"
+#include "loaded_latency.h"
+#include "pointer_chase.h"
+#include "affinity.h"
+#include "topology.h"
+#include <pthread.h>
+#include <atomic>
+
+/**
+ * The state shared by the latency thread and the traffic threads.
+ */
+struct traffic_shared {
+    char* buffer;
+    uint64_t bytes;
+    int threads;
+    enum traffic_type type;
+    uint64_t delay;
+    int cpu_node;
+    std::atomic<int> ready;
+    std::atomic<bool> go;
+    std::atomic<bool> stop;
+};
+
+/**
+ * The arguments and result of a single traffic thread.
+ */
+struct traffic_worker {
+    struct traffic_shared* shared;
+    int id;
+    uint64_t bytes_moved;
+    uint64_t sink;
+};
+
+/**
+ * The body of a traffic thread: streams over its chunk of the buffer until told to stop, counting the bytes moved
+ * once the measurement started.
+ */
+static void* traffic_thread(void* arg)
+{
+    struct traffic_worker* worker = (struct traffic_worker*)arg;
+    struct traffic_shared* shared = worker->shared;
+    pin_current_thread(numa_node_cpu(shared->cpu_node, worker->id + 1));
+
+    uint64_t lines = shared->bytes / CACHE_LINE_SIZE / shared->threads;
+    if (lines == 0) lines = 1;
+    uint64_t* chunk = (uint64_t*)(shared->buffer + (uint64_t)worker->id * lines * CACHE_LINE_SIZE);
+    const uint64_t words_per_line = CACHE_LINE_SIZE / sizeof(uint64_t);
+
+    shared->ready.fetch_add(1);
+    while (!shared->go.load(std::memory_order_acquire)) {
+    }
+
+    uint64_t moved = 0;
+    uint64_t sink = 0;
+    uint64_t line = 0;
+    while (!shared->stop.load(std::memory_order_relaxed)) {
+        uint64_t* p = chunk + line * words_per_line;
+        if (shared->type == TRAFFIC_READ) {
+            for (uint64_t w = 0; w < words_per_line; w++) sink += p[w];
+        } else {
+            for (uint64_t w = 0; w < words_per_line; w++) p[w] = line;
+        }
+        moved += CACHE_LINE_SIZE;
+        if (++line == lines) line = 0;
+        for (uint64_t d = 0; d < shared->delay; d++) {
+            __asm__ __volatile__("" ::: "memory");
+        }
+    }
+    worker->bytes_moved = moved;
+    worker->sink = sink;
+    return NULL;
+}
+
+int measure_loaded_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero, char* traffic,
+                           uint64_t traffic_bytes, int threads, enum traffic_type type, uint64_t delay, int cpu_node,
+                           struct loaded_latency_result* result)
+{
+    struct traffic_shared shared;
+    shared.buffer = traffic;
+    shared.bytes = traffic_bytes;
+    shared.threads = threads;
+    shared.type = type;
+    shared.delay = delay;
+    shared.cpu_node = cpu_node;
+    shared.ready.store(0);
+    shared.go.store(false);
+    shared.stop.store(false);
+
+    pin_current_thread(numa_node_cpu(cpu_node, 0));
+
+    pthread_t* tids = (pthread_t*)malloc((threads + 1) * sizeof(pthread_t));
+    struct traffic_worker* workers = (struct traffic_worker*)malloc((threads + 1) * sizeof(struct traffic_worker));
+    if (tids == NULL || workers == NULL) {
+        free(tids);
+        free(workers);
+        return -1;
+    }
+
+    int started = 0;
+    for (; started < threads; started++) {
+        workers[started].shared = &shared;
+        workers[started].id = started;
+        workers[started].bytes_moved = 0;
+        if (pthread_create(&tids[started], NULL, traffic_thread, &workers[started]) != 0) {
+            break;
+        }
+    }
+    if (started < threads) {
+        // Release the traffic threads that did start straight into their stop check, so they can be joined.
+        shared.stop.store(true);
+        shared.go.store(true, std::memory_order_release);
+        for (int t = 0; t < started; t++) {
+            pthread_join(tids[t], NULL);
+        }
+        free(tids);
+        free(workers);
+        return -1;
+    }
+    while (shared.ready.load() < started) {
+    }
+
+    uint64_t t0 = timer_now();
+    shared.go.store(true, std::memory_order_release);
+    result->latency = measure_pointer_chase_latency(repeat, arr, arr_size, zero);
+    shared.stop.store(true);
+    uint64_t t1 = timer_now();
+
+    uint64_t moved = 0;
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+        moved += workers[t].bytes_moved;
+        result->latency.rnd ^= workers[t].sink & zero;
+    }
+    result->bandwidth = moved / timer_ticks_to_ns(t1 - t0);
+
+    free(tids);
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef LOADED_LATENCY_H
+#define LOADED_LATENCY_H
+
+#include "memory_latency.h"
+
+
+/**
+ * The kind of background traffic generated while measuring loaded latency.
+ */
+enum traffic_type {
+    TRAFFIC_READ,
+    TRAFFIC_WRITE
+};
+
+
+/**
+ * Used as the return type for 'measure_loaded_latency'.
+ */
+struct loaded_latency_result {
+    struct measurement latency;     // the pointer-chasing measurement taken under load
+    double bandwidth;               // the bandwidth (GB/s) generated by the traffic threads meanwhile
+};
+
+
+/**
+ * Measures the pointer-chasing latency of an array while other threads generate background memory traffic.
+ * The calling thread is pinned to the first CPU of cpu_node and the traffic threads to the following ones. Every
+ * traffic thread streams over its own chunk of the traffic buffer a cache line at a time, spinning 'delay' iterations
+ * between lines, so larger delays inject less bandwidth.
+ * @param repeat - the number of times to repeat the latency measurement for and average on.
+ * @param arr - an array filled by build_random_cycle.
+ * @param arr_size - the length of the array arr.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param traffic - the buffer the traffic threads read or write, split between them.
+ * @param traffic_bytes - the size in bytes of the traffic buffer.
+ * @param threads - the number of traffic threads (0 measures the idle latency).
+ * @param type - whether the traffic threads read or write.
+ * @param delay - the number of spin iterations between two cache lines of traffic.
+ * @param cpu_node - the NUMA node whose CPUs run the threads, or -1 for any allowed CPU.
+ * @param result - filled with the measured latency and bandwidth.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_loaded_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero, char* traffic,
+                           uint64_t traffic_bytes, int threads, enum traffic_type type, uint64_t delay, int cpu_node,
+                           struct loaded_latency_result* result);
+
+#endif
@@ -2,8 +2,7 @@
 
 #include "memory_latency.h"
 #include "measure.h"
-
-#define GALOIS_POLYNOMIAL ((1ULL << 63) | (1ULL << 62) | (1ULL << 60) | (1ULL << 59))
+#include "prng.h"
 
 /**
  * Measures the average latency of accessing a given array.
@@ -15,43 +14,103 @@
  *      double baseline - the average time (ns) taken to preform the measured operation without memory access.
  *      double access_time - the average time (ns) taken to preform the measured operation with memory access.
  *      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
+ *      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
  */
 struct measurement measure_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero){
     repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
 
     // Baseline measurement:
-    struct timespec t0;
-    timespec_get(&t0, TIME_UTC);
+    uint64_t t0 = timer_now();
     register uint64_t rnd=12345;
     for (register uint64_t i = 0; i < repeat; i++)
     {
         register uint64_t index = rnd % arr_size;
         rnd ^= index & zero;
-        rnd = (rnd >> 1) ^ ((0-(rnd & 1)) & GALOIS_POLYNOMIAL);  // Advance rnd pseudo-randomly (using Galois LFSR)
+        rnd = lfsr_advance(rnd);  // Advance rnd pseudo-randomly (using Galois LFSR)
     }
-    struct timespec t1;
-    timespec_get(&t1, TIME_UTC);
+    uint64_t t1 = timer_now();
 
-    // Memory access measurement:
-    struct timespec t2;
-    timespec_get(&t2, TIME_UTC);
+    // Memory access measurement, with the perf counters around it:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
     rnd=(rnd & zero) ^ 12345;
     for (register uint64_t i = 0; i < repeat; i++)
     {
         register uint64_t index = rnd % arr_size;
         rnd ^= arr[index] & zero;
-        rnd = (rnd >> 1) ^ ((0-(rnd & 1)) & GALOIS_POLYNOMIAL);  // Advance rnd pseudo-randomly (using Galois LFSR)
+        rnd = lfsr_advance(rnd);  // Advance rnd pseudo-randomly (using Galois LFSR)
     }
-    struct timespec t3;
-    timespec_get(&t3, TIME_UTC);
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
 
     // Calculate baseline and memory access times:
-    double baseline_per_cycle=(double)(nanosectime(t1)- nanosectime(t0))/(repeat);
-    double memory_per_cycle=(double)(nanosectime(t3)- nanosectime(t2))/(repeat);
+    double baseline_per_cycle=timer_ticks_to_ns(t1 - t0)/(repeat);
+    double memory_per_cycle=timer_ticks_to_ns(t3 - t2)/(repeat);
+
+    result.baseline = baseline_per_cycle;
+    result.access_time = memory_per_cycle;
+    result.rnd = rnd;
+    return result;
+}
+
+/**
+* Measures the average latency of accessing a given array in a sequential order.
+* @param repeat - the number of times to repeat the measurement for and average on.
+* @param arr - an allocated (not empty) array to preform measurement on.
+* @param arr_size - the length of the array arr.
+* @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+* @return struct measurement containing the measurement with the following fields:
+*      double baseline - the average time (ns) taken to preform the measured operation without memory access.
+*      double access_time - the average time (ns) taken to preform the measured operation with memory access.
+*      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
+*      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
+*/
+struct measurement measure_sequential_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero){
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+
+    // Baseline measurement:
+    uint64_t t0 = timer_now();
+    register uint64_t rnd=12345;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        register uint64_t index = rnd % arr_size;
+        rnd ^= index & zero;
+        rnd++;
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it:
     struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    rnd=(rnd & zero) ^ 12345;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        register uint64_t index = rnd % arr_size;
+        rnd ^= arr[index] & zero;
+        rnd++;
+        }
+
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
+
+    // Calculate baseline and memory access times:
+    double baseline_per_cycle=timer_ticks_to_ns(t1 - t0)/(repeat);
+    double memory_per_cycle=timer_ticks_to_ns(t3 - t2)/(repeat);
 
     result.baseline = baseline_per_cycle;
     result.access_time = memory_per_cycle;
     result.rnd = rnd;
     return result;
 }
+
+/**
+ * Converts the struct timespec to time in nano-seconds.
+ * @param t - the struct timespec to convert.
+ * @return - the value of time in nano-seconds.
+ */
+uint64_t nanosectime(struct timespec t)
+{
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
@@ -15,6 +15,7 @@
  *      double baseline - the average time (ns) taken to preform the measured operation without memory access.
  *      double access_time - the average time (ns) taken to preform the measured operation with memory access.
  *      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
+ *      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
  */
 struct measurement measure_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero);
 
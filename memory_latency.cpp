@@ -1,156 +1,292 @@
 #include "memory_latency.h"
-#include "measure.h"
-#include <cmath>
+#include "sweeps.h"
+#include "probe.h"
+#include "loaded_latency.h"
+#include "mlp.h"
+#include "affinity.h"
+#include "allocation.h"
+#include "topology.h"
+#include "report.h"
+#include <string.h>
+#include <unistd.h>
 
 
-#define GALOIS_POLYNOMIAL ((1ULL << 63) | (1ULL << 62) | (1ULL << 60) | (1ULL << 59))
-
 /**
- * Converts the struct timespec to time in nano-seconds.
- * @param t - the struct timespec to convert.
- * @return - the value of time in nano-seconds.
+ * Prints the usage of the program to stderr.
+ * @param program - the name the program was run with.
  */
-uint64_t nanosectime(struct timespec t)
+static void print_usage(const char* program)
 {
-    return t.tv_sec * 1000000000ULL + t.tv_nsec;
-}
-
-/**
-* Measures the average latency of accessing a given array in a sequential order.
-* @param repeat - the number of times to repeat the measurement for and average on.
-* @param arr - an allocated (not empty) array to preform measurement on.
-* @param arr_size - the length of the array arr.
-* @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
-* @return struct measurement containing the measurement with the following fields:
-*      double baseline - the average time (ns) taken to preform the measured operation without memory access.
-*      double access_time - the average time (ns) taken to preform the measured operation with memory access.
-*      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
-*/
-struct measurement measure_sequential_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero){
-    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
-
-    // Baseline measurement:
-    struct timespec t0;
-    timespec_get(&t0, TIME_UTC);
-    register uint64_t rnd=12345;
-    for (register uint64_t i = 0; i < repeat; i++)
-    {
-        register uint64_t index = rnd % arr_size;
-        rnd ^= index & zero;
-        rnd++;
-    }
-    struct timespec t1;
-    timespec_get(&t1, TIME_UTC);
-
-    // Memory access measurement:
-    struct timespec t2;
-    timespec_get(&t2, TIME_UTC);
-    rnd=(rnd & zero) ^ 12345;
-    for (register uint64_t i = 0; i < repeat; i++)
-    {
-        register uint64_t index = rnd % arr_size;
-        rnd ^= arr[index] & zero;
-        rnd++;
-        }
-
-    struct timespec t3;
-    timespec_get(&t3, TIME_UTC);
-
-    // Calculate baseline and memory access times:
-    double baseline_per_cycle=(double)(nanosectime(t1)- nanosectime(t0))/(repeat);
-    double memory_per_cycle=(double)(nanosectime(t3)- nanosectime(t2))/(repeat);
-    struct measurement result;
-
-    result.baseline = baseline_per_cycle;
-    result.access_time = memory_per_cycle;
-    result.rnd = rnd;
-    return result;
+    fprintf(stderr, "Usage: %s [-m latency|bandwidth|loaded|c2c|numa|histogram|mlp|hierarchy|stride|simd|prefetch|"
+                    "family|tlb|assoc|sharing|atomic] [-t threads] [-w] [-d delay] [-n mem_node] [-c cpu_node] "
+                    "[-p 4k|thp|2m|1g] [-T timespec|raw|tsc] [-P] [-W] [-k trials] [-b batch] [-C chains] [-a [-l]] "
+                    "[-i init_threads] [-o plain|csv|json] max_size factor repeat\n", program);
 }
 
 /**
- * Runs the logic of the memory_latency program. Measures the access latency for random and sequential memory access
- * patterns.
- * Usage: './memory_latency max_size factor repeat' where:
+ * Runs the logic of the memory_latency program. Measures the access latency for random, sequential and pointer-chasing
+ * memory access patterns, the memory bandwidth, the latency under load, the core-to-core transfer latency, or the
+ * NUMA node-to-node latency and bandwidth.
+ * Usage: './memory_latency [-m mode] [-t threads] [-w] [-d delay] [-n mem_node] [-c cpu_node] [-p backing]
+ *                          [-T timer] [-P] [-W] [-k trials] [-b batch] [-C chains] [-a [-l]] [-i init_threads]
+ *                          [-o output] max_size factor repeat'
+ * where:
  *      - max_size - the maximum size in bytes of the array to measure access latency for.
  *      - factor - the factor in the geometric series representing the array sizes to check.
  *      - repeat - the number of times each measurement should be repeated for and averaged on.
- * The program will print output to stdout in the following format:
- *      mem_size_1,offset_1,offset_sequential_1
- *      mem_size_2,offset_2,offset_sequential_2
+ *      - mode - 'latency' (default), 'bandwidth', 'loaded', 'c2c', 'numa', 'histogram', 'mlp', 'hierarchy',
+ *               'stride', 'simd', 'prefetch', 'family', 'tlb', 'assoc', 'sharing' or 'atomic'.
+ *      - threads - the maximal number of threads for the bandwidth, sharing and atomic modes, or the number of
+ *                  traffic threads for the loaded mode (default: 1).
+ *      - -w - the traffic threads of the loaded mode write instead of read.
+ *      - delay - a single injection delay for the loaded mode, instead of sweeping a range of delays.
+ *      - mem_node - the NUMA node to bind the measured arrays to (default: first-touch placement).
+ *      - cpu_node - the NUMA node to run the measuring threads on (default: any allowed CPU).
+ *      - backing - the pages backing the measured arrays: '4k', 'thp', '2m' or '1g' (default: the system policy).
+ *      - timer - the clock the measurements are timed with: 'timespec' (default), 'raw' (CLOCK_MONOTONIC_RAW) or
+ *                'tsc' (rdtscp). Selecting one also reports the latency offsets in TSC cycles.
+ *      - -P - report perf counters (cycles, instructions, LLC misses, dTLB misses and walk cycles, or software events
+ *             if those aren't available) per access of the latency kernels. Their names are printed to stderr.
+ *      - -W - also report the store, read-modify-write and dirty-eviction variants of the random and sequential
+ *             kernels in the latency mode.
+ *      - trials - the number of independent trials of every latency point, reported as their median with outliers
+ *                 rejected, and followed by p5/p95, standard deviation and a bootstrap confidence interval
+ *                 (default: 1).
+ *      - batch - the number of dependent accesses timed together by the histogram mode (default: 16).
+ *      - chains - the maximal number of interleaved chains of the mlp mode (default: 16, at most MAX_CHASE_CHAINS).
+ *      - -a - allocate and pre-fault a single max_size arena once, and measure every size on a prefix of it, instead
+ *             of allocating an array per size.
+ *      - -l - also mlock the arena.
+ *      - init_threads - the maximal number of threads initialising the arrays of the latency, prefetch and
+ *                       family modes, each pinned to its own CPU and first-touching its own chunk (default: the
+ *                       allowed CPUs, or those of cpu_node).
+ *      - output - the format of the results: 'plain' (default) prints the CSV lines below, 'csv' prefixes them with
+ *                 '# key: value' metadata lines and a header line per table, and 'json' prints a metadata object
+ *                 followed by an object per line (JSON Lines).
+ * In the latency mode the program will print output to stdout in the following format:
+ *      mem_size_1,offset_1,offset_sequential_1,offset_chase_1
+ *      mem_size_2,offset_2,offset_sequential_2,offset_chase_2
  *              ...
  *              ...
  *              ...
+ * In the bandwidth mode it prints 'mem_size,threads,copy,scale,add,triad' lines, in GB/s.
+ * In the loaded mode it prints 'mem_size,threads,delay,bandwidth,offset_chase' lines.
+ * In the c2c mode it ignores max_size and factor, and prints a CPU x CPU matrix of transfer latencies (ns).
+ * In the numa mode it ignores factor, and prints node x node latency and bandwidth matrices for a max_size array.
+ * In the histogram mode it prints 'mem_size,p50,p90,p99,p99.9,max' lines of per-access latency percentiles (ns).
+ * In the mlp mode it prints 'mem_size,chains,offset,bandwidth' lines.
+ * In the hierarchy mode it prints a header line and a 'level,detected_size,latency,sysfs_size' line per cache level.
+ * In the stride mode it prints a 'mem_size,<stride>,...' header line, then a line of strided-walk offsets per size.
+ * In the simd mode it prints a header line, then a line per size of scalar, vector and non-temporal read, write and
+ * copy throughputs (GB/s).
+ * In the prefetch mode it prints 'mem_size,distance,gain_t0,gain_t1,gain_t2,gain_nta' lines.
+ * In the family mode it prints 'mem_size,element_size,unroll,offset,offset_sequential' lines.
+ * In the tlb mode it ignores factor, and prints a 'page_size,pages,span,offset,offset_resident,backing' line per page
+ * count of one access per page, for base and huge pages, then a 'page_size,level,entries,latency,cost,curve' line per
+ * detected translation level (l1_dtlb, stlb, any further l<N>_tlb, then walk; only l1_dtlb for a flat curve).
+ * In the assoc mode it ignores factor, and prints a 'spacing,addresses,offset' line per spacing and number of
+ * conflicting addresses, then a 'level,ways,sets,size,penalty,sysfs_ways,sysfs_sets' line per inferred cache level,
+ * and a 'spacing,conflict_addresses,slowdown,pathological' line per spacing.
+ * In the sharing mode it ignores max_size and factor, and prints 'threads,layout,stride,throughput,latency' lines,
+ * where repeat is the number of updates of every thread.
+ * In the atomic mode it ignores factor, and prints 'op,order,placement,threads,latency,throughput' lines.
  */
 int main(int argc, char* argv[])
 {
-    // zero==0, but the compiler doesn't know it. Use as the zero arg of measure_latency and measure_sequential_latency.
-    struct timespec t_dummy;
-    timespec_get(&t_dummy, TIME_UTC);
-    const uint64_t zero = nanosectime(t_dummy)>1000000000ull?0:nanosectime(t_dummy);
+    // zero==0, but the compiler doesn't know it. Use as the zero arg of measure_latency and
+    // measure_sequential_latency.
+    const uint64_t zero = memlat_zero();
 
-    // Your code here
-    if (argc != 4)
+    // Capture the allowed CPUs before any thread pins itself
+    allowed_cpu_count();
+
+    struct run_config config;
+    config.mode = MODE_LATENCY;
+    config.threads = 1;
+    config.traffic = TRAFFIC_READ;
+    config.delay = -1;
+    config.mem_node = -1;
+    config.cpu_node = -1;
+    config.backing = BACKING_DEFAULT;
+    config.timer = -1;
+    config.perf = false;
+    config.stores = false;
+    config.trials = 1;
+    config.batch = 16;
+    config.chains = 16;
+    config.init_threads = 0;
+    config.arena = NULL;
+    config.output = OUTPUT_PLAIN;
+    config.zero = zero;
+    bool use_arena = false;
+    bool lock_arena = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "m:t:wd:n:c:p:T:PWk:b:C:ali:o:")) != -1) {
+        switch (opt) {
+            case 'm':
+                if (parse_run_mode(optarg) < 0) {
+                    fprintf(stderr, "Error: unknown mode '%s'\n", optarg);
+                    return 1;
+                }
+                config.mode = (enum run_mode)parse_run_mode(optarg);
+                break;
+            case 't':
+                config.threads = atoi(optarg);
+                break;
+            case 'w':
+                config.traffic = TRAFFIC_WRITE;
+                break;
+            case 'd':
+                config.delay = strtoll(optarg, NULL, 10);
+                break;
+            case 'n':
+                config.mem_node = atoi(optarg);
+                break;
+            case 'c':
+                config.cpu_node = atoi(optarg);
+                break;
+            case 'T':
+                config.timer = parse_timer_backend(optarg);
+                if (config.timer < 0) {
+                    fprintf(stderr, "Error: unknown timer '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'b':
+                config.batch = strtoull(optarg, NULL, 10);
+                break;
+            case 'a':
+                use_arena = true;
+                break;
+            case 'l':
+                lock_arena = true;
+                break;
+            case 'i':
+                config.init_threads = atoi(optarg);
+                break;
+            case 'C':
+                config.chains = atoi(optarg);
+                break;
+            case 'k':
+                config.trials = atoi(optarg);
+                break;
+            case 'P':
+                config.perf = true;
+                break;
+            case 'W':
+                config.stores = true;
+                break;
+            case 'o':
+                config.output = parse_output_format(optarg);
+                if (config.output < 0) {
+                    fprintf(stderr, "Error: unknown output format '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'p':
+                config.backing = parse_page_backing(optarg);
+                if (config.backing < 0) {
+                    fprintf(stderr, "Error: unknown page backing '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (argc - optind != 3)
     {
-        fprintf(stderr, "Usage: %s max_size factor repeat\n", argv[0]);
+        print_usage(argv[0]);
         return 1;
     }
-    uint64_t max_size = strtoull(argv[1], NULL, 10);
-    double factor = atof(argv[2]);
-    uint64_t repeat = strtoull(argv[3], NULL, 10);
+    config.max_size = strtoull(argv[optind], NULL, 10);
+    config.factor = atof(argv[optind + 1]);
+    config.repeat = strtoull(argv[optind + 2], NULL, 10);
 
-    if (max_size < 100){
+    if (config.max_size < 100){
         fprintf(stderr, "Error: max_size must be at least 100\n");
         return 1;
     }
 
-    if (factor <= 1.0) {
+    if (config.factor <= 1.0) {
         fprintf(stderr, "Error: factor must be greater than 1.0\n");
         return -1;
     }
 
-    if (repeat == 0) {
+    if (config.repeat == 0) {
         fprintf(stderr, "Error: repeat must be greater than 0\n");
         return -1;
     }
 
-    // Start with an array size of 100 bytes
-    uint64_t array_size_bytes = 100;
+    if (config.batch == 0) {
+        fprintf(stderr, "Error: batch must be greater than 0\n");
+        return -1;
+    }
 
-    // Loop until we reach or exceed the maximum size
-    while (array_size_bytes <= max_size) {
-        // Calculate number of elements needed for this array size
-        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
-        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+    if (config.chains <= 0 || config.chains > MAX_CHASE_CHAINS) {
+        fprintf(stderr, "Error: chains must be between 1 and %d\n", MAX_CHASE_CHAINS);
+        return -1;
+    }
 
-        // Allocate array
-        array_element_t* arr = (array_element_t*)malloc(array_size_elements * sizeof(array_element_t));
-        if (arr == NULL) {
-            fprintf(stderr, "Error: Failed to allocate memory\n");
-            return -1;
-        }
+    if (config.trials <= 0) {
+        fprintf(stderr, "Error: trials must be greater than 0\n");
+        return -1;
+    }
 
-        // Initialize array with unique values as recommended
-        for (uint64_t i = 0; i < array_size_elements; i++) {
-            arr[i] = rand();  // Park-Miller parameters for variety
-        }
+    // The loaded mode accepts 0 traffic threads, to measure the idle latency the same way.
+    if (config.threads < 0 || (config.threads == 0 && config.mode != MODE_LOADED_LATENCY)) {
+        fprintf(stderr, "Error: threads must be greater than 0\n");
+        return -1;
+    }
 
-        // Run measurements...
-        struct measurement random_result = measure_latency(repeat, arr, array_size_elements, zero);
-        struct measurement sequential_result = measure_sequential_latency(repeat, arr, array_size_elements, zero);
+    if (config.init_threads < 0) {
+        fprintf(stderr, "Error: init_threads must be greater than 0\n");
+        return -1;
+    }
+    if (config.init_threads == 0) {
+        cpu_set_t node_cpus;
+        config.init_threads = config.cpu_node >= 0 && numa_node_cpus(config.cpu_node, &node_cpus) == 0
+                              ? CPU_COUNT(&node_cpus) : allowed_cpu_count();
+    }
 
-        // Calculate offsets
-        double random_offset = random_result.access_time - random_result.baseline;
-        double sequential_offset = sequential_result.access_time - sequential_result.baseline;
+    if (memlat_init(config.timer >= 0 ? (enum timer_backend)config.timer : TIMER_TIMESPEC) != 0) {
+        fprintf(stderr, "Error: the selected timer isn't supported on this machine\n");
+        return -1;
+    }
 
-        // Print results
-        printf("%lu,%.2f,%.2f\n", array_size_bytes, random_offset, sequential_offset);
+    if (config.perf) {
+        if (perf_counters_open() == 0) {
+            fprintf(stderr, "Error: perf_event_open isn't available (see /proc/sys/kernel/perf_event_paranoid)\n");
+            return -1;
+        }
+        fprintf(stderr, "perf counters:");
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) fprintf(stderr, " %s", perf_counter_name(c));
+        fprintf(stderr, "\n");
+    }
 
-        // Free the array
-        free(arr);
+    if (config.cpu_node >= 0 && run_on_numa_node(config.cpu_node) != 0) {
+        fprintf(stderr, "Error: Failed to run on NUMA node %d\n", config.cpu_node);
+        return -1;
+    }
 
-        // Calculate next array size using ceiling as specified
-        array_size_bytes = ceil(array_size_bytes * factor);
+    if (use_arena) {
+        config.arena = (array_element_t*)alloc_array(config.max_size, config.mem_node,
+                                                     (enum page_backing)config.backing);
+        if (config.arena == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        if (prefault_array(config.arena, config.max_size, lock_arena) != 0) {
+            fprintf(stderr, "Warning: Failed to lock the arena (see ulimit -l)\n");
+        }
     }
 
-      return 0;
+    report_init(&config, argc, argv);
+    int status = run_sweep(&config);
+
+    free_array(config.arena, config.max_size, (enum page_backing)config.backing);
+    return status == 0 ? 0 : -1;
 }
\ No newline at end of file
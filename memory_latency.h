@@ -6,9 +6,13 @@
 #include <stdio.h>
 #include <time.h>
 #include <stdint.h>
+#include "timer.h"
+#include "perf_counters.h"
 
 typedef uint64_t array_element_t;
 
+#define CACHE_LINE_SIZE 64
+
 
 /**
  * Used as the return type for 'measure_latency'.
@@ -17,6 +21,65 @@ struct measurement {
     double baseline;
     double access_time;
     uint64_t rnd;
+    double counters[PERF_COUNTER_COUNT];
+};
+
+
+/**
+ * The signature shared by the latency kernels (measure_latency, measure_sequential_latency, ...).
+ */
+typedef struct measurement (*latency_kernel_t)(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                               uint64_t zero);
+
+
+/**
+ * The measurement modes of the memory_latency program.
+ */
+enum run_mode {
+    MODE_LATENCY,
+    MODE_BANDWIDTH,
+    MODE_LOADED_LATENCY,
+    MODE_CORE_TO_CORE,
+    MODE_NUMA_MATRIX,
+    MODE_HISTOGRAM,
+    MODE_MLP,
+    MODE_HIERARCHY,
+    MODE_STRIDE,
+    MODE_SIMD,
+    MODE_PREFETCH,
+    MODE_FAMILY,
+    MODE_TLB,
+    MODE_ASSOC,
+    MODE_SHARING,
+    MODE_ATOMIC,
+    MODE_COUNT
+};
+
+
+/**
+ * The configuration of a run, as parsed from the command line.
+ */
+struct run_config {
+    enum run_mode mode;
+    uint64_t max_size;
+    double factor;
+    uint64_t repeat;
+    int threads;
+    int traffic;        // enum traffic_type of the loaded mode
+    int64_t delay;      // the injection delay of the loaded mode, or -1 to sweep
+    int mem_node;       // the NUMA node the measured arrays are bound to, or -1
+    int cpu_node;       // the NUMA node the measuring threads run on, or -1
+    int backing;        // enum page_backing of the measured arrays
+    int timer;          // enum timer_backend the measurements are timed with, or -1 for the default
+    bool perf;          // whether to report the perf counters of the latency kernels
+    bool stores;        // whether to report the store, read-modify-write and dirty variants of the latency kernels
+    int trials;         // the number of independent trials of every latency point
+    uint64_t batch;     // the number of dependent accesses timed together by the histogram mode
+    int chains;         // the maximal number of interleaved chains of the mlp mode
+    int init_threads;   // the maximal number of threads initialising the measured arrays
+    array_element_t* arena;     // the pre-faulted max_size arena every size is measured on, or NULL
+    int output;         // the enum output_format of the results
+    uint64_t zero;
 };
 
 
@@ -38,6 +101,7 @@ uint64_t nanosectime(struct timespec t);
 *      double baseline - the average time (ns) taken to preform the measured operation without memory access.
 *      double access_time - the average time (ns) taken to preform the measured operation with memory access.
 *      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
+*      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
 */
 struct measurement measure_sequential_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero);
 
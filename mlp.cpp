@@ -0,0 +1,63 @@
+#include "memory_latency.h"
+#include "mlp.h"
+
+/**
+ * The kernel for a fixed number of chains, so the loop over the chains is unrolled and their indices stay in
+ * registers.
+ */
+template <int CHAINS>
+static struct measurement chase_chains(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    uint64_t rounds = (repeat + CHAINS - 1) / CHAINS;
+    uint64_t index[CHAINS];
+
+    // Baseline measurement - the same chains, without the loads:
+    for (int k = 0; k < CHAINS; k++) index[k] = k * arr_size / CHAINS;
+    uint64_t t0 = timer_now();
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        for (int k = 0; k < CHAINS; k++) index[k] ^= i & zero;
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement:
+    struct measurement result;
+    for (int k = 0; k < CHAINS; k++) index[k] = (index[k] & zero) + k * arr_size / CHAINS;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        for (int k = 0; k < CHAINS; k++) index[k] = arr[index[k]];
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(rounds * CHAINS, result.counters);
+
+    result.baseline = timer_ticks_to_ns(t1 - t0) / (rounds * CHAINS);
+    result.access_time = timer_ticks_to_ns(t3 - t2) / (rounds * CHAINS);
+    result.rnd = 0;
+    for (int k = 0; k < CHAINS; k++) result.rnd ^= index[k];
+    return result;
+}
+
+typedef struct measurement (*chains_kernel_t)(uint64_t, array_element_t*, uint64_t, uint64_t);
+
+/**
+ * The kernels for 1..MAX_CHASE_CHAINS chains, indexed by chains - 1.
+ */
+static const chains_kernel_t CHAINS_KERNELS[MAX_CHASE_CHAINS] = {
+    chase_chains<1>, chase_chains<2>, chase_chains<3>, chase_chains<4>,
+    chase_chains<5>, chase_chains<6>, chase_chains<7>, chase_chains<8>,
+    chase_chains<9>, chase_chains<10>, chase_chains<11>, chase_chains<12>,
+    chase_chains<13>, chase_chains<14>, chase_chains<15>, chase_chains<16>,
+    chase_chains<17>, chase_chains<18>, chase_chains<19>, chase_chains<20>,
+    chase_chains<21>, chase_chains<22>, chase_chains<23>, chase_chains<24>,
+    chase_chains<25>, chase_chains<26>, chase_chains<27>, chase_chains<28>,
+    chase_chains<29>, chase_chains<30>, chase_chains<31>, chase_chains<32>,
+};
+
+struct measurement measure_mlp_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                       int chains)
+{
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+    return CHAINS_KERNELS[chains - 1](repeat, arr, arr_size, zero);
+}
@@ -0,0 +1,28 @@
+#ifndef MLP_H
+#define MLP_H
+
+#include "memory_latency.h"
+
+#define MAX_CHASE_CHAINS 32
+
+
+/**
+ * Measures the average latency of an access when several independent pointer-chasing chains are interleaved in one
+ * loop. Each chain depends on its own previous load only, so up to 'chains' misses can be outstanding at once, and
+ * the effective latency drops until the memory-level parallelism of the core is saturated.
+ * The chains start at the elements k * arr_size / chains, which lie at random, well separated positions of the
+ * cycle.
+ * @param repeat - the total number of accesses to repeat the measurement for and average on, split between the chains.
+ * @param arr - an array filled by build_random_cycle.
+ * @param arr_size - the length of the array arr.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param chains - the number of interleaved chains, in [1, MAX_CHASE_CHAINS].
+ * @return struct measurement containing the measurement with the following fields:
+ *      double baseline - the average time (ns) per access of the same loop without memory access.
+ *      double access_time - the average time (ns) per access of the loop with memory access.
+ *      uint64_t rnd - a combination of the last indices visited, returned to prevent compiler optimizations.
+ */
+struct measurement measure_mlp_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                       int chains);
+
+#endif
@@ -0,0 +1,141 @@
+#include "perf_counters.h"
+#include <linux/perf_event.h>
+#include <math.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+// DTLB_LOAD_MISSES.WALK_ACTIVE (event 0x08, umask 0x10) on Intel Skylake and later.
+#define INTEL_DTLB_WALK_ACTIVE 0x1008
+
+/**
+ * The definition of one counter of the group.
+ */
+struct counter_definition {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+static const struct counter_definition HARDWARE_COUNTERS[PERF_COUNTER_COUNT] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlb_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {"walk_cycles", PERF_TYPE_RAW, INTEL_DTLB_WALK_ACTIVE},
+};
+
+static const struct counter_definition SOFTWARE_COUNTERS[PERF_COUNTER_COUNT] = {
+    {"task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    {"cpu_migrations", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_MIGRATIONS},
+    {"minor_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN},
+};
+
+static const struct counter_definition* counters = HARDWARE_COUNTERS;
+static int fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1, -1};
+
+/**
+ * Opens a single counter of the calling thread, user space only.
+ * @param definition - the counter to open.
+ * @param group_fd - the leader of the group, or -1 to open a new group.
+ * @return - the file descriptor of the counter, or -1 on failure.
+ */
+static int open_counter(const struct counter_definition* definition, int group_fd)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = definition->type;
+    attr.config = definition->config;
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/**
+ * Returns whether the CPU is an Intel one, where the raw page walk event is defined.
+ */
+static bool is_intel_cpu()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0, &eax, &ebx, &ecx, &edx) == 0) {
+        return false;
+    }
+    return ebx == 0x756e6547 && edx == 0x49656e69 && ecx == 0x6c65746e;  // "GenuineIntel"
+#else
+    return false;
+#endif
+}
+
+/**
+ * Opens as many counters of a definition table as possible, the first one as the group leader.
+ * @return - the number of counters opened.
+ */
+static int open_group(const struct counter_definition* definitions)
+{
+    fds[0] = open_counter(&definitions[0], -1);
+    if (fds[0] == -1) {
+        return 0;
+    }
+    int opened = 1;
+    for (int i = 1; i < PERF_COUNTER_COUNT; i++) {
+        if (definitions[i].type == PERF_TYPE_RAW && !is_intel_cpu()) {
+            continue;
+        }
+        fds[i] = open_counter(&definitions[i], fds[0]);
+        if (fds[i] != -1) opened++;
+    }
+    return opened;
+}
+
+int perf_counters_open()
+{
+    counters = HARDWARE_COUNTERS;
+    int opened = open_group(HARDWARE_COUNTERS);
+    if (opened == 0) {
+        counters = SOFTWARE_COUNTERS;
+        opened = open_group(SOFTWARE_COUNTERS);
+    }
+    return opened;
+}
+
+bool perf_counters_enabled()
+{
+    return fds[0] != -1;
+}
+
+const char* perf_counter_name(int index)
+{
+    return counters[index].name;
+}
+
+void perf_counters_start()
+{
+    if (fds[0] == -1) return;
+    ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void perf_counters_stop(uint64_t accesses, double rates[PERF_COUNTER_COUNT])
+{
+    if (fds[0] != -1) {
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+    for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+        uint64_t count;
+        if (fds[i] == -1 || read(fds[i], &count, sizeof(count)) != sizeof(count)) {
+            rates[i] = NAN;
+            continue;
+        }
+        rates[i] = (double)count / accesses;
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#define PERF_COUNTER_COUNT 5
+
+
+/**
+ * Opens a group of counters for the calling thread with perf_event_open: cycles, instructions, LLC misses, dTLB load
+ * misses and page walk cycles (the last one only on Intel CPUs). If the hardware counters can't be opened (e.g. in a
+ * virtual machine), software events are used instead: task clock (ns), page faults, context switches, CPU migrations
+ * and minor faults. Counters that can't be opened are reported as NaN.
+ * @return - the number of counters opened, or 0 if perf_event_open isn't available at all.
+ */
+int perf_counters_open();
+
+
+/**
+ * Returns whether perf_counters_open opened any counter, so the kernels should collect them.
+ * @return - true if the counters are open.
+ */
+bool perf_counters_enabled();
+
+
+/**
+ * Returns the name of a counter in the opened group.
+ * @param index - the index of the counter, in [0, PERF_COUNTER_COUNT).
+ * @return - the name of the counter.
+ */
+const char* perf_counter_name(int index);
+
+
+/**
+ * Resets and starts the counter group. Does nothing if the counters aren't open.
+ */
+void perf_counters_start();
+
+
+/**
+ * Stops the counter group and reads the counts, divided by the number of accesses.
+ * @param accesses - the number of accesses made since perf_counters_start.
+ * @param rates - filled with the per-access count of every counter (NaN for counters that couldn't be opened).
+ */
+void perf_counters_stop(uint64_t accesses, double rates[PERF_COUNTER_COUNT]);
+
+#endif
@@ -16,9 +16,10 @@ l3_size = 9 * 1024 * 1024  # 9 MiB shared
 # Create the plot
 plt.figure(figsize=(10, 6))
 
-# Plot both access patterns
+# Plot all access patterns
 plt.plot(data[:, 0], data[:, 1], label="Random access", color='blue')
 plt.plot(data[:, 0], data[:, 2], label="Sequential access", color='orange')
+plt.plot(data[:, 0], data[:, 3], label="Pointer chasing", color='purple')
 
 # Use logarithmic scales for both axes
 plt.xscale('log')
@@ -0,0 +1,87 @@
+#include "memory_latency.h"
+#include "pointer_chase.h"
+#include "prng.h"
+
+
+void build_random_cycle(array_element_t* arr, uint64_t arr_size, uint64_t seed)
+{
+    for (uint64_t i = 0; i < arr_size; i++) {
+        arr[i] = i;
+    }
+
+    // Sattolo's shuffle: picking j strictly below i yields one cycle through all the elements.
+    uint64_t state = seed;
+    for (uint64_t i = arr_size - 1; i > 0; i--) {
+        uint64_t j = splitmix64(&state) % i;
+        array_element_t tmp = arr[i];
+        arr[i] = arr[j];
+        arr[j] = tmp;
+    }
+}
+
+void build_stride_cycle(array_element_t* arr, uint64_t arr_size, uint64_t stride)
+{
+    for (uint64_t i = 0; i < arr_size; i += stride) {
+        arr[i] = i + stride < arr_size ? i + stride : 0;
+    }
+}
+
+int build_spaced_cycle(array_element_t* arr, uint64_t count, uint64_t spacing, uint64_t seed)
+{
+    // Shuffle the order of the elements (Sattolo's shuffle, as above), then link each one to the next.
+    uint64_t* order = (uint64_t*)malloc(count * sizeof(uint64_t));
+    if (order == NULL) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    uint64_t state = seed;
+    for (uint64_t i = count - 1; i > 0; i--) {
+        uint64_t j = splitmix64(&state) % i;
+        uint64_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        arr[i * spacing] = order[i] * spacing;
+    }
+    free(order);
+    return 0;
+}
+
+struct measurement measure_pointer_chase_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                 uint64_t zero)
+{
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+
+    // Baseline measurement - the same dependency chain, without the load:
+    uint64_t t0 = timer_now();
+    register uint64_t index = 0;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        index ^= i & zero;
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    index &= zero;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        index = arr[index];
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
+
+    // Calculate baseline and memory access times:
+    double baseline_per_cycle=timer_ticks_to_ns(t1 - t0)/(repeat);
+    double memory_per_cycle=timer_ticks_to_ns(t3 - t2)/(repeat);
+
+    result.baseline = baseline_per_cycle;
+    result.access_time = memory_per_cycle;
+    result.rnd = index;
+    return result;
+}
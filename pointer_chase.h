@@ -0,0 +1,56 @@
+#ifndef POINTER_CHASE_H
+#define POINTER_CHASE_H
+
+#include "memory_latency.h"
+
+
+/**
+ * Fills the given array with a single random cycle that visits every element exactly once (Sattolo's algorithm).
+ * After the call, arr[i] holds the index of the element that follows i in the cycle.
+ * @param arr - an allocated (not empty) array to fill.
+ * @param arr_size - the length of the array arr.
+ * @param seed - the seed of the pseudo-random generator used to shuffle the cycle.
+ */
+void build_random_cycle(array_element_t* arr, uint64_t arr_size, uint64_t seed);
+
+
+/**
+ * Fills the given array with a cycle that visits the elements 0, stride, 2 * stride, ... in order and then returns
+ * to 0, like the strided walks of Saavedra's benchmark. The other elements are left untouched.
+ * @param arr - an allocated (not empty) array to fill.
+ * @param arr_size - the length of the array arr.
+ * @param stride - the distance in elements between two consecutive elements of the cycle (at least 1).
+ */
+void build_stride_cycle(array_element_t* arr, uint64_t arr_size, uint64_t stride);
+
+
+/**
+ * Fills the given array with a single random cycle through the elements 0, spacing, 2 * spacing, ...,
+ * (count - 1) * spacing, all of which map to the same cache sets when spacing is a multiple of a cache way. The other
+ * elements are left untouched.
+ * @param arr - an allocated array of at least (count - 1) * spacing + 1 elements.
+ * @param count - the number of elements in the cycle (at least 1).
+ * @param spacing - the distance in elements between the elements of the cycle (at least 1).
+ * @param seed - the seed of the pseudo-random generator used to shuffle the cycle.
+ * @return 0 on success, -1 on failure.
+ */
+int build_spaced_cycle(array_element_t* arr, uint64_t count, uint64_t spacing, uint64_t seed);
+
+
+/**
+ * Measures the average latency of a dependent load, by chasing the cycle stored in the array. The address of every
+ * load is the value returned by the previous load, so the CPU can not overlap consecutive accesses.
+ * @param repeat - the number of times to repeat the measurement for and average on.
+ * @param arr - an array filled by build_random_cycle.
+ * @param arr_size - the length of the array arr.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @return struct measurement containing the measurement with the following fields:
+ *      double baseline - the average time (ns) taken to preform the measured operation without memory access.
+ *      double access_time - the average time (ns) taken to preform the measured operation with memory access.
+ *      uint64_t rnd - the last index visited, returned to prevent compiler optimizations.
+ *      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
+ */
+struct measurement measure_pointer_chase_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                 uint64_t zero);
+
+#endif
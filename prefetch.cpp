@@ -0,0 +1,69 @@
+#include "memory_latency.h"
+#include "prefetch.h"
+#include "prng.h"
+
+/**
+ * The kernel for a fixed locality, since __builtin_prefetch only takes it as a compile time constant
+ * (3 for T0 down to 0 for NTA).
+ */
+template <int LOCALITY>
+static struct measurement prefetch_kernel(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                          int distance)
+{
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+
+    // The prefetching generator starts 'distance' steps ahead of the accessing one
+    uint64_t ahead = 12345;
+    for (int d = 0; d < distance; d++) ahead = lfsr_advance(ahead);
+
+    // Baseline measurement - both generators, without memory access:
+    uint64_t t0 = timer_now();
+    register uint64_t rnd = 12345;
+    register uint64_t pf = ahead;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        register uint64_t index = rnd % arr_size;
+        rnd ^= (index ^ (pf % arr_size)) & zero;
+        rnd = lfsr_advance(rnd);
+        pf = lfsr_advance(pf);
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    rnd = (rnd & zero) ^ 12345;
+    pf = (pf & zero) ^ ahead;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        __builtin_prefetch(&arr[pf % arr_size], 0, LOCALITY);
+        register uint64_t index = rnd % arr_size;
+        rnd ^= arr[index] & zero;
+        rnd = lfsr_advance(rnd);
+        pf = lfsr_advance(pf);
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
+
+    result.baseline = timer_ticks_to_ns(t1 - t0) / repeat;
+    result.access_time = timer_ticks_to_ns(t3 - t2) / repeat;
+    result.rnd = rnd ^ pf;
+    return result;
+}
+
+struct measurement measure_prefetch_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                            enum prefetch_hint hint, int distance)
+{
+    switch (hint) {
+        case PREFETCH_T1:
+            return prefetch_kernel<2>(repeat, arr, arr_size, zero, distance);
+        case PREFETCH_T2:
+            return prefetch_kernel<1>(repeat, arr, arr_size, zero, distance);
+        case PREFETCH_NTA:
+            return prefetch_kernel<0>(repeat, arr, arr_size, zero, distance);
+        case PREFETCH_T0:
+        default:
+            return prefetch_kernel<3>(repeat, arr, arr_size, zero, distance);
+    }
+}
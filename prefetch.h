@@ -0,0 +1,41 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "memory_latency.h"
+
+#define MAX_PREFETCH_DISTANCE 256
+
+
+/**
+ * The locality hints of a software prefetch, as the x86 instructions they map to.
+ */
+enum prefetch_hint {
+    PREFETCH_T0,    // into every cache level
+    PREFETCH_T1,    // into L2 and beyond
+    PREFETCH_T2,    // into the last level cache
+    PREFETCH_NTA,   // close to the core, but marked for early eviction
+    PREFETCH_HINT_COUNT
+};
+
+
+/**
+ * Measures the average time per access of the random kernel (measure_latency), when every iteration also prefetches
+ * the element the kernel will access 'distance' iterations later. The prefetched indices come from a second copy of
+ * the index generator running 'distance' steps ahead, which doesn't depend on memory, as in a hash join that hashes
+ * its keys ahead of the probes.
+ * @param repeat - the number of times to repeat the measurement for and average on.
+ * @param arr - an allocated (not empty) array to preform measurement on.
+ * @param arr_size - the length of the array arr.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @param hint - the locality hint of the prefetches.
+ * @param distance - the number of iterations to prefetch ahead, in [1, MAX_PREFETCH_DISTANCE].
+ * @return struct measurement containing the measurement with the following fields:
+ *      double baseline - the average time (ns) per iteration of the same loop without memory access.
+ *      double access_time - the average time (ns) per iteration of the loop with the accesses and the prefetches.
+ *      uint64_t rnd - the variable used to randomly access the array, returned to prevent compiler optimizations.
+ *      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
+ */
+struct measurement measure_prefetch_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero,
+                                            enum prefetch_hint hint, int distance);
+
+#endif
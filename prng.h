@@ -0,0 +1,74 @@
+#ifndef PRNG_H
+#define PRNG_H
+
+#include <stdint.h>
+
+#define SPLITMIX64_GAMMA 0x9E3779B97F4A7C15ULL
+#define GALOIS_POLYNOMIAL ((1ULL << 63) | (1ULL << 62) | (1ULL << 60) | (1ULL << 59))
+
+
+/**
+ * Advances a Galois LFSR by one step: the pseudo-random index generator of measure_latency and of the kernels that
+ * follow its access pattern.
+ * @param rnd - the state of the LFSR.
+ * @return - the next state.
+ */
+static inline uint64_t lfsr_advance(uint64_t rnd)
+{
+    return (rnd >> 1) ^ ((0 - (rnd & 1)) & GALOIS_POLYNOMIAL);
+}
+
+
+/**
+ * The splitmix64 output function: scrambles a 64 bit value into a pseudo-random one.
+ * @param z - the value to scramble.
+ * @return - a pseudo-random 64 bit value.
+ */
+static inline uint64_t splitmix64_mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * Advances the given state and returns the next value of the splitmix64 pseudo-random sequence.
+ * @param state - the generator state, updated in place.
+ * @return - a pseudo-random 64 bit value.
+ */
+static inline uint64_t splitmix64(uint64_t* state)
+{
+    return splitmix64_mix(*state += SPLITMIX64_GAMMA);
+}
+
+
+/**
+ * Returns the value at a given position of the splitmix64 sequence of a seed, without generating the ones before it.
+ * This makes the generator counter-based: any range of the sequence can be generated independently.
+ * @param seed - the seed of the sequence.
+ * @param counter - the position in the sequence (0 for the first value).
+ * @return - a pseudo-random 64 bit value, equal to the (counter + 1)-th call of splitmix64 on a state of seed.
+ */
+static inline uint64_t splitmix64_at(uint64_t seed, uint64_t counter)
+{
+    return splitmix64_mix(seed + (counter + 1) * SPLITMIX64_GAMMA);
+}
+
+
+/**
+ * A bijection on the values below a power of two: a multiplication by an odd constant and an xorshift. Applied to
+ * the full period LCG state = 5 * state + 1 (mod mask + 1), it visits every value once per period, in an order that
+ * loses the regular low bits of the LCG, without any table in memory.
+ * @param value - the value to scramble, at most mask.
+ * @param mask - a power of two minus one.
+ * @param shift - the xorshift distance, (log2(mask + 1) + 1) / 2.
+ * @return - the scrambled value, at most mask.
+ */
+static inline uint64_t scramble_pow2(uint64_t value, uint64_t mask, int shift)
+{
+    value = (value * SPLITMIX64_GAMMA) & mask;
+    return value ^ (value >> shift);
+}
+
+#endif
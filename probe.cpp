@@ -0,0 +1,114 @@
+#include "memory_latency.h"
+#include "probe.h"
+#include "measure.h"
+#include "pointer_chase.h"
+#include "store.h"
+#include "init.h"
+#include "simd.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * The kernels of the patterns, indexed by enum probe_pattern.
+ */
+static const latency_kernel_t PROBE_KERNELS[PROBE_PATTERN_COUNT] = {
+    measure_latency,
+    measure_sequential_latency,
+    measure_pointer_chase_latency,
+    measure_store_latency,
+    measure_rmw_latency,
+    measure_dirty_latency,
+};
+
+int memlat_init(enum timer_backend backend)
+{
+    allowed_cpu_count();
+    if (timer_init(backend) != 0) {
+        return -1;
+    }
+    simd_init();
+    return 0;
+}
+
+uint64_t memlat_zero()
+{
+    struct timespec t_dummy;
+    timespec_get(&t_dummy, TIME_UTC);
+    return nanosectime(t_dummy)>1000000000ull?0:nanosectime(t_dummy);
+}
+
+void probe_config_init(struct probe_config* config, enum probe_pattern pattern, uint64_t size)
+{
+    config->pattern = pattern;
+    config->size = size;
+    config->repeat = 1000000;
+    config->trials = 5;
+    config->cpu = -1;
+    config->mem_node = -1;
+    config->backing = BACKING_DEFAULT;
+    config->init_threads = allowed_cpu_count();
+}
+
+/**
+ * Measures the working set of a probe, once the calling thread is placed.
+ */
+static int measure_probe(const struct probe_config* config, struct probe_result* result)
+{
+    uint64_t elements = config->size / sizeof(array_element_t);
+    if (elements == 0) elements = 1;  // Ensure at least one element
+    array_element_t* arr = (array_element_t*)alloc_array(elements * sizeof(array_element_t), config->mem_node,
+                                                         config->backing);
+    if (arr == NULL) {
+        return -1;
+    }
+    if (fill_random_parallel(arr, elements, config->size, config->init_threads, -1) != 0) {
+        free_array(arr, elements * sizeof(array_element_t), config->backing);
+        return -1;
+    }
+    if (config->pattern == PROBE_CHASE) {
+        build_random_cycle(arr, elements, config->size);
+    }
+
+    const uint64_t zero = memlat_zero();
+    double* offsets = (double*)malloc(config->trials * sizeof(double));
+    if (offsets == NULL) {
+        free_array(arr, elements * sizeof(array_element_t), config->backing);
+        return -1;
+    }
+    for (int t = 0; t < config->trials; t++) {
+        result->last = PROBE_KERNELS[config->pattern](config->repeat, arr, elements, zero);
+        offsets[t] = result->last.access_time - result->last.baseline;
+    }
+    int status = compute_trial_statistics(offsets, config->trials, &result->stats);
+    free(offsets);
+    if (status != 0) {
+        free_array(arr, elements * sizeof(array_element_t), config->backing);
+        return -1;
+    }
+    result->latency = result->stats.median;
+    result->cycles = ns_to_cycles(result->latency);
+
+    free_array(arr, elements * sizeof(array_element_t), config->backing);
+    return 0;
+}
+
+int run_probe(const struct probe_config* config, struct probe_result* result)
+{
+    if (config->pattern < 0 || config->pattern >= PROBE_PATTERN_COUNT || config->trials <= 0 ||
+        config->repeat == 0 || config->init_threads <= 0) {
+        return -1;
+    }
+    if (config->cpu < 0) {
+        return measure_probe(config, result);
+    }
+
+    cpu_set_t previous;
+    if (pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous) != 0 ||
+        pin_current_thread(config->cpu) != 0) {
+        return -1;
+    }
+    int status = measure_probe(config, result);
+    pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+    return status;
+}
@@ -0,0 +1,86 @@
+#ifndef PROBE_H
+#define PROBE_H
+
+#include "memory_latency.h"
+#include "allocation.h"
+#include "statistics.h"
+
+
+/**
+ * The access patterns a probe can measure.
+ */
+enum probe_pattern {
+    PROBE_RANDOM,       // measure_latency
+    PROBE_SEQUENTIAL,   // measure_sequential_latency
+    PROBE_CHASE,        // measure_pointer_chase_latency, over a random cycle
+    PROBE_STORE,        // measure_store_latency
+    PROBE_RMW,          // measure_rmw_latency
+    PROBE_DIRTY,        // measure_dirty_latency
+    PROBE_PATTERN_COUNT
+};
+
+
+/**
+ * The configuration of a single probe: one access pattern over one working set.
+ */
+struct probe_config {
+    enum probe_pattern pattern;
+    uint64_t size;              // the size of the working set in bytes
+    uint64_t repeat;            // the number of accesses of every trial (at least one per element)
+    int trials;                 // the number of independent trials
+    int cpu;                    // the CPU to measure on, or -1 to stay where the calling thread runs
+    int mem_node;               // the NUMA node to bind the working set to, or -1 for first-touch placement
+    enum page_backing backing;  // the pages backing the working set
+    int init_threads;           // the maximal number of threads initialising the working set
+};
+
+
+/**
+ * The result of a single probe.
+ */
+struct probe_result {
+    double latency;                 // the median offset (access_time - baseline) of the trials, in ns per access
+    double cycles;                  // the same, in TSC cycles
+    struct trial_statistics stats;  // the statistics of the offsets of the trials
+    struct measurement last;        // the raw measurement of the last trial
+};
+
+
+/**
+ * Initialises the library: captures the CPUs the process may run on, selects and calibrates the timer, and selects
+ * the instruction set of the streaming kernels. Must be called once, before any measurement and before any thread
+ * of the process is pinned.
+ * @param backend - the timer to time the measurements with.
+ * @return 0 on success, -1 if the timer isn't supported on this machine.
+ */
+int memlat_init(enum timer_backend backend);
+
+
+/**
+ * Returns zero, in a way the compiler can't know in compilation time, for the zero argument of the kernels.
+ * @return - zero.
+ */
+uint64_t memlat_zero();
+
+
+/**
+ * Fills a probe configuration with the defaults: 5 trials of at least 1000000 accesses, on the calling thread's CPU,
+ * with first-touch placement, the default page backing, and one initialisation thread per allowed CPU.
+ * @param config - the configuration to fill.
+ * @param pattern - the access pattern to measure.
+ * @param size - the size of the working set in bytes.
+ */
+void probe_config_init(struct probe_config* config, enum probe_pattern pattern, uint64_t size);
+
+
+/**
+ * Measures the latency of one access pattern over one working set. The working set is allocated, initialised and
+ * freed by the probe. When config->cpu is set, the calling thread is pinned to it for the duration of the probe,
+ * and its previous affinity is restored afterwards.
+ * @param config - the configuration of the probe.
+ * @param result - filled with the result of the probe.
+ * @return 0 on success, -1 on failure.
+ */
+int run_probe(const struct probe_config* config, struct probe_result* result);
+
+#endif
@@ -0,0 +1,282 @@
+#include "memory_latency.h"
+#include "report.h"
+#include "sweeps.h"
+#include "allocation.h"
+#include "topology.h"
+#include "affinity.h"
+#include "simd.h"
+#include "loaded_latency.h"
+#include <cmath>
+#include <string>
+#include <string.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#ifndef MEMLAT_CXXFLAGS
+#define MEMLAT_CXXFLAGS "unknown"     // set by the build
+#endif
+
+static enum output_format format = OUTPUT_PLAIN;
+
+// The line being built by report_begin ... report_end, and the header of the previous one.
+static std::string table_name;
+static bool table_plain_header = false;
+static std::string line;
+static std::string columns;
+static std::string printed_columns;
+
+int parse_output_format(const char* name)
+{
+    if (strcmp(name, "plain") == 0) return OUTPUT_PLAIN;
+    if (strcmp(name, "csv") == 0) return OUTPUT_CSV;
+    if (strcmp(name, "json") == 0) return OUTPUT_JSON;
+    return -1;
+}
+
+/**
+ * Returns a string as a quoted JSON string.
+ */
+static std::string json_string(const char* value)
+{
+    std::string quoted = "\"";
+    for (const char* c = value; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            quoted += '\\';
+            quoted += *c;
+        } else if ((unsigned char)*c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", *c);
+            quoted += escaped;
+        } else {
+            quoted += *c;
+        }
+    }
+    return quoted + "\"";
+}
+
+/**
+ * Adds a column to the line being built: 'value' is printed as is in CSV, and 'json_value' in JSON.
+ */
+static void add_column(const char* name, const std::string& value, const std::string& json_value)
+{
+    bool first = columns.empty();
+    columns += first ? "" : ",";
+    columns += name;
+    if (format == OUTPUT_JSON) {
+        line += "," + json_string(name) + ":" + json_value;
+    } else {
+        line += first ? "" : ",";
+        line += value;
+    }
+}
+
+void report_begin(const char* table, bool plain_header)
+{
+    table_name = table;
+    table_plain_header = plain_header;
+    line.clear();
+    columns.clear();
+    if (format == OUTPUT_JSON) {
+        line = "{\"type\":" + json_string(table);
+    }
+}
+
+void report_uint(const char* name, uint64_t value)
+{
+    std::string text = std::to_string((unsigned long long)value);
+    add_column(name, text, text);
+}
+
+void report_int(const char* name, int value)
+{
+    std::string text = std::to_string(value);
+    add_column(name, text, text);
+}
+
+void report_double(const char* name, double value, int precision)
+{
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", precision, value);
+    add_column(name, text, std::isfinite(value) ? text : "null");
+}
+
+void report_string(const char* name, const char* value)
+{
+    add_column(name, value, json_string(value));
+}
+
+void report_empty(const char* name)
+{
+    add_column(name, "", "null");
+}
+
+void report_end()
+{
+    if (format == OUTPUT_JSON) {
+        printf("%s}\n", line.c_str());
+    } else {
+        bool header = format == OUTPUT_CSV || table_plain_header;
+        if (header && columns != printed_columns) {
+            printf("%s\n", columns.c_str());
+            printed_columns = columns;
+        }
+        printf("%s\n", line.c_str());
+    }
+    fflush(stdout);
+}
+
+/**
+ * Reads the first line of a file, without its newline.
+ * @return - the line, or an empty string if the file can't be read.
+ */
+static std::string read_first_line(const char* path)
+{
+    char buffer[256] = "";
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return "";
+    }
+    if (fgets(buffer, sizeof(buffer), file) == NULL) buffer[0] = '\0';
+    fclose(file);
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return buffer;
+}
+
+/**
+ * Returns the CPU model, from the 'model name' line of /proc/cpuinfo.
+ */
+static std::string cpu_model()
+{
+    char buffer[512];
+    std::string model = "unknown";
+    FILE* file = fopen("/proc/cpuinfo", "r");
+    if (file == NULL) {
+        return model;
+    }
+    while (fgets(buffer, sizeof(buffer), file) != NULL) {
+        const char* colon = strchr(buffer, ':');
+        if (strncmp(buffer, "model name", 10) == 0 && colon != NULL) {
+            model = colon + 1 + strspn(colon + 1, " \t");
+            model.erase(model.find_last_not_of("\n") + 1);
+            break;
+        }
+    }
+    fclose(file);
+    return model;
+}
+
+/**
+ * Returns the data caches of a CPU as 'L<level>:<size>:<ways>' items separated by ';'.
+ */
+static std::string cache_topology(int cpu)
+{
+    struct cache_info caches[MAX_CACHE_LEVELS];
+    int count = read_cache_info(cpu, caches, MAX_CACHE_LEVELS);
+    std::string topology;
+    for (int i = 0; i < count; i++) {
+        char item[64];
+        snprintf(item, sizeof(item), "%sL%d:%lu:%d", i == 0 ? "" : ";", caches[i].level, caches[i].size,
+                 caches[i].ways);
+        topology += item;
+    }
+    return topology.empty() ? "unknown" : topology;
+}
+
+/**
+ * Returns the selected value of a sysfs setting printed as 'a [b] c', or the whole line if none is selected.
+ */
+static std::string selected_setting(const char* path)
+{
+    std::string setting = read_first_line(path);
+    size_t open = setting.find('['), close = setting.find(']');
+    if (open != std::string::npos && close != std::string::npos && close > open) {
+        return setting.substr(open + 1, close - open - 1);
+    }
+    return setting.empty() ? "unknown" : setting;
+}
+
+/**
+ * Prints one metadata item as a '# name: value' line in CSV, or appends it to the metadata object in JSON.
+ * @param json - the metadata object being built.
+ * @param name - the name of the item.
+ * @param value - the value of the item.
+ * @param number - whether the value is a number (printed without quotes in JSON).
+ */
+static void add_metadata(std::string* json, const char* name, const std::string& value, bool number)
+{
+    if (format == OUTPUT_JSON) {
+        *json += "," + json_string(name) + ":" + (number ? value : json_string(value.c_str()));
+    } else {
+        printf("# %s: %s\n", name, value.c_str());
+    }
+}
+
+void report_init(const struct run_config* config, int argc, char* argv[])
+{
+    format = (enum output_format)config->output;
+    if (format == OUTPUT_PLAIN) {
+        return;
+    }
+
+    static const char* const TIMER_NAMES[] = {"timespec", "raw", "tsc"};
+    static const char* const BACKING_NAMES[] = {"default", "4k", "thp", "2m", "1g"};
+    int cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 0) : allowed_cpu(0);
+
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    struct utsname system;
+    std::string kernel = uname(&system) == 0 ? std::string(system.sysname) + " " + system.release : "unknown";
+    char timestamp[32];
+    time_t now = time(NULL);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    char governor_path[128];
+    snprintf(governor_path, sizeof(governor_path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    char tsc[32];
+    snprintf(tsc, sizeof(tsc), "%.3f", tsc_ghz());
+    char factor[32];
+    snprintf(factor, sizeof(factor), "%g", config->factor);
+    std::string command;
+    for (int i = 0; i < argc; i++) {
+        command += (i == 0 ? "" : " ");
+        command += argv[i];
+    }
+
+    std::string json = "{\"type\":\"metadata\"";
+    add_metadata(&json, "host", host, false);
+    add_metadata(&json, "timestamp", timestamp, false);
+    add_metadata(&json, "cpu_model", cpu_model(), false);
+    add_metadata(&json, "cpus", std::to_string(allowed_cpu_count()), true);
+    add_metadata(&json, "numa_nodes", std::to_string(numa_node_count()), true);
+    add_metadata(&json, "caches", cache_topology(cpu), false);
+    add_metadata(&json, "kernel", kernel, false);
+    add_metadata(&json, "thp", selected_setting("/sys/kernel/mm/transparent_hugepage/enabled"), false);
+    add_metadata(&json, "governor", selected_setting(governor_path), false);
+    add_metadata(&json, "tsc_ghz", tsc, true);
+    add_metadata(&json, "compiler", __VERSION__, false);
+    add_metadata(&json, "build_flags", MEMLAT_CXXFLAGS, false);
+    add_metadata(&json, "simd", simd_isa_name(simd_isa_in_use), false);
+    add_metadata(&json, "command", command, false);
+    add_metadata(&json, "mode", run_mode_name(config->mode), false);
+    add_metadata(&json, "max_size", std::to_string((unsigned long long)config->max_size), true);
+    add_metadata(&json, "factor", factor, true);
+    add_metadata(&json, "repeat", std::to_string((unsigned long long)config->repeat), true);
+    add_metadata(&json, "threads", std::to_string(config->threads), true);
+    add_metadata(&json, "trials", std::to_string(config->trials), true);
+    add_metadata(&json, "timer", TIMER_NAMES[timer_backend_in_use], false);
+    add_metadata(&json, "backing", BACKING_NAMES[config->backing], false);
+    add_metadata(&json, "mem_node", std::to_string(config->mem_node), true);
+    add_metadata(&json, "cpu_node", std::to_string(config->cpu_node), true);
+    add_metadata(&json, "init_threads", std::to_string(config->init_threads), true);
+    add_metadata(&json, "arena", config->arena != NULL ? "true" : "false", true);
+    add_metadata(&json, "perf", config->perf ? "true" : "false", true);
+    add_metadata(&json, "stores", config->stores ? "true" : "false", true);
+    add_metadata(&json, "traffic", config->traffic == TRAFFIC_READ ? "read" : "write", false);
+    add_metadata(&json, "delay", std::to_string((long long)config->delay), true);
+    add_metadata(&json, "batch", std::to_string((unsigned long long)config->batch), true);
+    add_metadata(&json, "chains", std::to_string(config->chains), true);
+    if (format == OUTPUT_JSON) {
+        printf("%s}\n", json.c_str());
+    }
+    fflush(stdout);
+}
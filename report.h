@@ -0,0 +1,58 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "memory_latency.h"
+
+
+/**
+ * The formats the results can be printed in.
+ */
+enum output_format {
+    OUTPUT_PLAIN,   // bare CSV lines, with a header line only in the modes that always had one
+    OUTPUT_CSV,     // '# key: value' metadata lines, then CSV lines under a header line naming the columns
+    OUTPUT_JSON     // JSON lines: a metadata object, then an object per result line
+};
+
+
+/**
+ * Parses the name of an output format ('plain', 'csv' or 'json').
+ * @param name - the name to parse.
+ * @return - the output format, or -1 if the name is unknown.
+ */
+int parse_output_format(const char* name);
+
+
+/**
+ * Selects the output format and prints the metadata of the run: the host (name, CPU model, caches, kernel version,
+ * transparent huge pages setting, frequency governor), the build (compiler and flags), and every parameter of the
+ * run. Nothing is printed in the plain format. Must be called after memlat_init, and before the first result.
+ * @param config - the configuration of the run.
+ * @param argc - the number of command line arguments.
+ * @param argv - the command line arguments, reported as the command of the run.
+ */
+void report_init(const struct run_config* config, int argc, char* argv[]);
+
+
+/**
+ * Starts a result line of a table. The columns are then added in order with the report_* functions, and the line is
+ * printed (and flushed) by report_end. In the CSV formats, a header line naming the columns is printed before the
+ * line whenever they differ from those of the previous line; in the plain format, only for tables whose header is
+ * part of their plain output.
+ * @param table - the name of the table (e.g. 'latency'), the 'type' of the JSON objects.
+ * @param plain_header - whether the header line is printed in the plain format too.
+ */
+void report_begin(const char* table, bool plain_header);
+
+void report_uint(const char* name, uint64_t value);
+void report_int(const char* name, int value);
+void report_double(const char* name, double value, int precision);  // NaN is printed as null in JSON
+void report_string(const char* name, const char* value);
+void report_empty(const char* name);                                // an empty cell, null in JSON
+
+
+/**
+ * Prints the result line started by report_begin.
+ */
+void report_end();
+
+#endif
@@ -0,0 +1,441 @@
+#include "memory_latency.h"
+#include "simd.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Keeps the compiler from vectorising the scalar kernels, or from replacing them with calls to memset and memcpy.
+#if defined(__GNUC__) && !defined(__clang__)
+#define SCALAR_KERNEL __attribute__((optimize("no-tree-vectorize", "no-tree-loop-distribute-patterns")))
+#else
+#define SCALAR_KERNEL
+#endif
+
+#define WRITE_PATTERN 0x5A5A5A5A5A5A5A5AULL
+
+enum simd_isa simd_isa_in_use = SIMD_SCALAR;
+
+/**
+ * A streaming kernel: reads 'src', writes 'dst', or copies 'src' to 'dst', over 'bytes' bytes (a multiple of
+ * SIMD_BLOCK_SIZE). Read kernels return a combination of the values read, to prevent compiler optimizations.
+ */
+typedef uint64_t (*stream_kernel_t)(char* dst, const char* src, uint64_t bytes);
+
+SCALAR_KERNEL static uint64_t scalar_read(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    const uint64_t* p = (const uint64_t*)src;
+    uint64_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+    for (uint64_t i = 0; i < bytes / sizeof(uint64_t); i += 4) {
+        a0 ^= p[i];
+        a1 ^= p[i + 1];
+        a2 ^= p[i + 2];
+        a3 ^= p[i + 3];
+    }
+    return a0 ^ a1 ^ a2 ^ a3;
+}
+
+SCALAR_KERNEL static uint64_t scalar_write(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    uint64_t* p = (uint64_t*)dst;
+    for (uint64_t i = 0; i < bytes / sizeof(uint64_t); i++) {
+        p[i] = WRITE_PATTERN;
+    }
+    return 0;
+}
+
+SCALAR_KERNEL static uint64_t scalar_copy(char* dst, const char* src, uint64_t bytes)
+{
+    uint64_t* d = (uint64_t*)dst;
+    const uint64_t* s = (const uint64_t*)src;
+    for (uint64_t i = 0; i < bytes / sizeof(uint64_t); i++) {
+        d[i] = s[i];
+    }
+    return 0;
+}
+
+#if defined(__x86_64__)
+
+/**
+ * Folds the lanes of a 128 bit vector into 64 bits.
+ */
+static inline uint64_t fold128(__m128i v)
+{
+    return (uint64_t)_mm_cvtsi128_si64(_mm_xor_si128(v, _mm_unpackhi_epi64(v, v)));
+}
+
+// SSE2: 16 byte vectors, four per block of 64 bytes; NT loads (movntdqa) need SSE4.1.
+
+__attribute__((target("sse2"))) static uint64_t sse2_read(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        a0 = _mm_xor_si128(a0, _mm_load_si128((const __m128i*)(src + i)));
+        a1 = _mm_xor_si128(a1, _mm_load_si128((const __m128i*)(src + i + 16)));
+        a2 = _mm_xor_si128(a2, _mm_load_si128((const __m128i*)(src + i + 32)));
+        a3 = _mm_xor_si128(a3, _mm_load_si128((const __m128i*)(src + i + 48)));
+    }
+    return fold128(_mm_xor_si128(_mm_xor_si128(a0, a1), _mm_xor_si128(a2, a3)));
+}
+
+__attribute__((target("sse4.1"))) static uint64_t sse41_read_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        a0 = _mm_xor_si128(a0, _mm_stream_load_si128((__m128i*)(src + i)));
+        a1 = _mm_xor_si128(a1, _mm_stream_load_si128((__m128i*)(src + i + 16)));
+        a2 = _mm_xor_si128(a2, _mm_stream_load_si128((__m128i*)(src + i + 32)));
+        a3 = _mm_xor_si128(a3, _mm_stream_load_si128((__m128i*)(src + i + 48)));
+    }
+    return fold128(_mm_xor_si128(_mm_xor_si128(a0, a1), _mm_xor_si128(a2, a3)));
+}
+
+__attribute__((target("sse2"))) static uint64_t sse2_write(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m128i v = _mm_set1_epi64x(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        _mm_store_si128((__m128i*)(dst + i), v);
+        _mm_store_si128((__m128i*)(dst + i + 16), v);
+        _mm_store_si128((__m128i*)(dst + i + 32), v);
+        _mm_store_si128((__m128i*)(dst + i + 48), v);
+    }
+    return 0;
+}
+
+__attribute__((target("sse2"))) static uint64_t sse2_write_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m128i v = _mm_set1_epi64x(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        _mm_stream_si128((__m128i*)(dst + i), v);
+        _mm_stream_si128((__m128i*)(dst + i + 16), v);
+        _mm_stream_si128((__m128i*)(dst + i + 32), v);
+        _mm_stream_si128((__m128i*)(dst + i + 48), v);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+__attribute__((target("sse2"))) static uint64_t sse2_copy(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        __m128i v0 = _mm_load_si128((const __m128i*)(src + i));
+        __m128i v1 = _mm_load_si128((const __m128i*)(src + i + 16));
+        __m128i v2 = _mm_load_si128((const __m128i*)(src + i + 32));
+        __m128i v3 = _mm_load_si128((const __m128i*)(src + i + 48));
+        _mm_store_si128((__m128i*)(dst + i), v0);
+        _mm_store_si128((__m128i*)(dst + i + 16), v1);
+        _mm_store_si128((__m128i*)(dst + i + 32), v2);
+        _mm_store_si128((__m128i*)(dst + i + 48), v3);
+    }
+    return 0;
+}
+
+__attribute__((target("sse4.1"))) static uint64_t sse41_copy_nt(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 64) {
+        __m128i v0 = _mm_stream_load_si128((__m128i*)(src + i));
+        __m128i v1 = _mm_stream_load_si128((__m128i*)(src + i + 16));
+        __m128i v2 = _mm_stream_load_si128((__m128i*)(src + i + 32));
+        __m128i v3 = _mm_stream_load_si128((__m128i*)(src + i + 48));
+        _mm_stream_si128((__m128i*)(dst + i), v0);
+        _mm_stream_si128((__m128i*)(dst + i + 16), v1);
+        _mm_stream_si128((__m128i*)(dst + i + 32), v2);
+        _mm_stream_si128((__m128i*)(dst + i + 48), v3);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+// AVX2: 32 byte vectors, four per block of 128 bytes.
+
+__attribute__((target("avx2"))) static uint64_t avx2_read(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        a0 = _mm256_xor_si256(a0, _mm256_load_si256((const __m256i*)(src + i)));
+        a1 = _mm256_xor_si256(a1, _mm256_load_si256((const __m256i*)(src + i + 32)));
+        a2 = _mm256_xor_si256(a2, _mm256_load_si256((const __m256i*)(src + i + 64)));
+        a3 = _mm256_xor_si256(a3, _mm256_load_si256((const __m256i*)(src + i + 96)));
+    }
+    __m256i a = _mm256_xor_si256(_mm256_xor_si256(a0, a1), _mm256_xor_si256(a2, a3));
+    return fold128(_mm_xor_si128(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+}
+
+__attribute__((target("avx2"))) static uint64_t avx2_read_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        a0 = _mm256_xor_si256(a0, _mm256_stream_load_si256((const __m256i*)(src + i)));
+        a1 = _mm256_xor_si256(a1, _mm256_stream_load_si256((const __m256i*)(src + i + 32)));
+        a2 = _mm256_xor_si256(a2, _mm256_stream_load_si256((const __m256i*)(src + i + 64)));
+        a3 = _mm256_xor_si256(a3, _mm256_stream_load_si256((const __m256i*)(src + i + 96)));
+    }
+    __m256i a = _mm256_xor_si256(_mm256_xor_si256(a0, a1), _mm256_xor_si256(a2, a3));
+    return fold128(_mm_xor_si128(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1)));
+}
+
+__attribute__((target("avx2"))) static uint64_t avx2_write(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m256i v = _mm256_set1_epi64x(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        _mm256_store_si256((__m256i*)(dst + i), v);
+        _mm256_store_si256((__m256i*)(dst + i + 32), v);
+        _mm256_store_si256((__m256i*)(dst + i + 64), v);
+        _mm256_store_si256((__m256i*)(dst + i + 96), v);
+    }
+    return 0;
+}
+
+__attribute__((target("avx2"))) static uint64_t avx2_write_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m256i v = _mm256_set1_epi64x(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        _mm256_stream_si256((__m256i*)(dst + i), v);
+        _mm256_stream_si256((__m256i*)(dst + i + 32), v);
+        _mm256_stream_si256((__m256i*)(dst + i + 64), v);
+        _mm256_stream_si256((__m256i*)(dst + i + 96), v);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+__attribute__((target("avx2"))) static uint64_t avx2_copy(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        __m256i v0 = _mm256_load_si256((const __m256i*)(src + i));
+        __m256i v1 = _mm256_load_si256((const __m256i*)(src + i + 32));
+        __m256i v2 = _mm256_load_si256((const __m256i*)(src + i + 64));
+        __m256i v3 = _mm256_load_si256((const __m256i*)(src + i + 96));
+        _mm256_store_si256((__m256i*)(dst + i), v0);
+        _mm256_store_si256((__m256i*)(dst + i + 32), v1);
+        _mm256_store_si256((__m256i*)(dst + i + 64), v2);
+        _mm256_store_si256((__m256i*)(dst + i + 96), v3);
+    }
+    return 0;
+}
+
+__attribute__((target("avx2"))) static uint64_t avx2_copy_nt(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 128) {
+        __m256i v0 = _mm256_stream_load_si256((const __m256i*)(src + i));
+        __m256i v1 = _mm256_stream_load_si256((const __m256i*)(src + i + 32));
+        __m256i v2 = _mm256_stream_load_si256((const __m256i*)(src + i + 64));
+        __m256i v3 = _mm256_stream_load_si256((const __m256i*)(src + i + 96));
+        _mm256_stream_si256((__m256i*)(dst + i), v0);
+        _mm256_stream_si256((__m256i*)(dst + i + 32), v1);
+        _mm256_stream_si256((__m256i*)(dst + i + 64), v2);
+        _mm256_stream_si256((__m256i*)(dst + i + 96), v3);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+// AVX-512: 64 byte vectors, four per block of SIMD_BLOCK_SIZE bytes.
+
+/**
+ * Folds the lanes of a 512 bit vector into 64 bits.
+ */
+__attribute__((target("avx512f"))) static inline uint64_t fold512(__m512i v)
+{
+    alignas(64) uint64_t lanes[8];
+    _mm512_store_si512((void*)lanes, v);
+    return lanes[0] ^ lanes[1] ^ lanes[2] ^ lanes[3] ^ lanes[4] ^ lanes[5] ^ lanes[6] ^ lanes[7];
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_read(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m512i a0 = _mm512_setzero_si512(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        a0 = _mm512_xor_si512(a0, _mm512_load_si512((const void*)(src + i)));
+        a1 = _mm512_xor_si512(a1, _mm512_load_si512((const void*)(src + i + 64)));
+        a2 = _mm512_xor_si512(a2, _mm512_load_si512((const void*)(src + i + 128)));
+        a3 = _mm512_xor_si512(a3, _mm512_load_si512((const void*)(src + i + 192)));
+    }
+    return fold512(_mm512_xor_si512(_mm512_xor_si512(a0, a1), _mm512_xor_si512(a2, a3)));
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_read_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)dst;
+    __m512i a0 = _mm512_setzero_si512(), a1 = a0, a2 = a0, a3 = a0;
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        a0 = _mm512_xor_si512(a0, _mm512_stream_load_si512((void*)(src + i)));
+        a1 = _mm512_xor_si512(a1, _mm512_stream_load_si512((void*)(src + i + 64)));
+        a2 = _mm512_xor_si512(a2, _mm512_stream_load_si512((void*)(src + i + 128)));
+        a3 = _mm512_xor_si512(a3, _mm512_stream_load_si512((void*)(src + i + 192)));
+    }
+    return fold512(_mm512_xor_si512(_mm512_xor_si512(a0, a1), _mm512_xor_si512(a2, a3)));
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_write(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m512i v = _mm512_set1_epi64(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        _mm512_store_si512((void*)(dst + i), v);
+        _mm512_store_si512((void*)(dst + i + 64), v);
+        _mm512_store_si512((void*)(dst + i + 128), v);
+        _mm512_store_si512((void*)(dst + i + 192), v);
+    }
+    return 0;
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_write_nt(char* dst, const char* src, uint64_t bytes)
+{
+    (void)src;
+    const __m512i v = _mm512_set1_epi64(WRITE_PATTERN);
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        _mm512_stream_si512((__m512i*)(dst + i), v);
+        _mm512_stream_si512((__m512i*)(dst + i + 64), v);
+        _mm512_stream_si512((__m512i*)(dst + i + 128), v);
+        _mm512_stream_si512((__m512i*)(dst + i + 192), v);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_copy(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        __m512i v0 = _mm512_load_si512((const void*)(src + i));
+        __m512i v1 = _mm512_load_si512((const void*)(src + i + 64));
+        __m512i v2 = _mm512_load_si512((const void*)(src + i + 128));
+        __m512i v3 = _mm512_load_si512((const void*)(src + i + 192));
+        _mm512_store_si512((void*)(dst + i), v0);
+        _mm512_store_si512((void*)(dst + i + 64), v1);
+        _mm512_store_si512((void*)(dst + i + 128), v2);
+        _mm512_store_si512((void*)(dst + i + 192), v3);
+    }
+    return 0;
+}
+
+__attribute__((target("avx512f"))) static uint64_t avx512_copy_nt(char* dst, const char* src, uint64_t bytes)
+{
+    for (uint64_t i = 0; i < bytes; i += 256) {
+        __m512i v0 = _mm512_stream_load_si512((void*)(src + i));
+        __m512i v1 = _mm512_stream_load_si512((void*)(src + i + 64));
+        __m512i v2 = _mm512_stream_load_si512((void*)(src + i + 128));
+        __m512i v3 = _mm512_stream_load_si512((void*)(src + i + 192));
+        _mm512_stream_si512((__m512i*)(dst + i), v0);
+        _mm512_stream_si512((__m512i*)(dst + i + 64), v1);
+        _mm512_stream_si512((__m512i*)(dst + i + 128), v2);
+        _mm512_stream_si512((__m512i*)(dst + i + 192), v3);
+    }
+    _mm_sfence();
+    return 0;
+}
+
+#endif
+
+/**
+ * The kernels of every instruction set, indexed by enum simd_isa, then by operation and path (the scalar path of
+ * every row is the scalar kernel). Rows are only used once simd_init found the instruction set supported.
+ */
+static stream_kernel_t SIMD_KERNELS[][SIMD_OP_COUNT][PATH_COUNT] = {
+    {   // SIMD_SCALAR
+        {scalar_read, scalar_read, scalar_read},
+        {scalar_write, scalar_write, scalar_write},
+        {scalar_copy, scalar_copy, scalar_copy},
+    },
+#if defined(__x86_64__)
+    {   // SIMD_SSE2, the NT read and copy are patched by simd_init without SSE4.1
+        {scalar_read, sse2_read, sse41_read_nt},
+        {scalar_write, sse2_write, sse2_write_nt},
+        {scalar_copy, sse2_copy, sse41_copy_nt},
+    },
+    {   // SIMD_AVX2
+        {scalar_read, avx2_read, avx2_read_nt},
+        {scalar_write, avx2_write, avx2_write_nt},
+        {scalar_copy, avx2_copy, avx2_copy_nt},
+    },
+    {   // SIMD_AVX512
+        {scalar_read, avx512_read, avx512_read_nt},
+        {scalar_write, avx512_write, avx512_write_nt},
+        {scalar_copy, avx512_copy, avx512_copy_nt},
+    },
+#endif
+};
+
+void simd_init()
+{
+#if defined(__x86_64__)
+    // __builtin_cpu_supports reads cpuid, and only reports the AVX extensions when xgetbv shows the OS saves them.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        simd_isa_in_use = SIMD_AVX512;
+    } else if (__builtin_cpu_supports("avx2")) {
+        simd_isa_in_use = SIMD_AVX2;
+    } else {
+        simd_isa_in_use = SIMD_SSE2;    // part of x86-64
+        if (!__builtin_cpu_supports("sse4.1")) {
+            SIMD_KERNELS[SIMD_SSE2][SIMD_READ][PATH_NT] = sse2_read;
+            SIMD_KERNELS[SIMD_SSE2][SIMD_COPY][PATH_NT] = sse2_copy;
+        }
+    }
+#else
+    simd_isa_in_use = SIMD_SCALAR;
+#endif
+}
+
+const char* simd_isa_name(enum simd_isa isa)
+{
+    switch (isa) {
+        case SIMD_SSE2:
+            return "sse2";
+        case SIMD_AVX2:
+            return "avx2";
+        case SIMD_AVX512:
+            return "avx512";
+        case SIMD_SCALAR:
+        default:
+            return "scalar";
+    }
+}
+
+int measure_simd_bandwidth(uint64_t repeat, uint64_t size_bytes, int mem_node, enum page_backing backing,
+                           struct simd_result* result)
+{
+    const uint64_t granule = 2 * SIMD_BLOCK_SIZE;
+    uint64_t bytes = (size_bytes + granule - 1) / granule * granule;
+    uint64_t half = bytes / 2;
+    uint64_t passes = (repeat * sizeof(uint64_t) + bytes - 1) / bytes;
+    if (passes == 0) passes = 1;
+
+    char* buffer = (char*)alloc_array(bytes, mem_node, backing);
+    if (buffer == NULL) {
+        return -1;
+    }
+    scalar_write(buffer, NULL, bytes);  // Fault the pages in before timing
+
+    uint64_t sink = 0;
+    for (int op = 0; op < SIMD_OP_COUNT; op++) {
+        for (int path = 0; path < PATH_COUNT; path++) {
+            stream_kernel_t kernel = SIMD_KERNELS[simd_isa_in_use][op][path];
+            uint64_t t0 = timer_now();
+            for (uint64_t p = 0; p < passes; p++) {
+                if (op == SIMD_COPY) {
+                    sink ^= kernel(buffer + half, buffer, half);
+                } else {
+                    sink ^= kernel(buffer, buffer, bytes);
+                }
+            }
+            uint64_t t1 = timer_now();
+            // A copy reads one half and writes the other, so every operation moves 'bytes' bytes per pass.
+            result->bandwidth[op][path] = (double)bytes * passes / timer_ticks_to_ns(t1 - t0);
+        }
+    }
+
+    free_array(buffer, bytes, backing);
+    result->rnd = sink;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "memory_latency.h"
+#include "allocation.h"
+
+// The kernels move SIMD_BLOCK_SIZE bytes per iteration (four 64 byte AVX-512 vectors), so buffers are rounded to it.
+#define SIMD_BLOCK_SIZE 256
+
+
+/**
+ * The instruction sets the streaming kernels are implemented in, from the narrowest to the widest.
+ */
+enum simd_isa {
+    SIMD_SCALAR,    // 8 byte general-purpose loads and stores
+    SIMD_SSE2,      // 16 byte vectors (non-temporal loads need SSE4.1)
+    SIMD_AVX2,      // 32 byte vectors
+    SIMD_AVX512     // 64 byte vectors
+};
+
+enum simd_op { SIMD_READ, SIMD_WRITE, SIMD_COPY, SIMD_OP_COUNT };
+
+enum simd_path {
+    PATH_SCALAR,    // the scalar kernel
+    PATH_VECTOR,    // the kernel in the widest supported instruction set
+    PATH_NT,        // the same, with non-temporal (streaming) loads and stores
+    PATH_COUNT
+};
+
+
+/**
+ * Used as the return type for 'measure_simd_bandwidth'. Every field is the throughput (GB/s) of one operation
+ * through one path.
+ */
+struct simd_result {
+    double bandwidth[SIMD_OP_COUNT][PATH_COUNT];
+    uint64_t rnd;   // a combination of the values read, returned to prevent compiler optimizations
+};
+
+
+/**
+ * The widest instruction set supported by both the CPU and the OS, set by simd_init.
+ */
+extern enum simd_isa simd_isa_in_use;
+
+
+/**
+ * Selects the widest instruction set the CPU and the OS support, using cpuid (and xgetbv for the AVX state).
+ */
+void simd_init();
+
+
+/**
+ * Returns the name of an instruction set ('scalar', 'sse2', 'avx2' or 'avx512').
+ * @param isa - the instruction set.
+ * @return - the name of the instruction set.
+ */
+const char* simd_isa_name(enum simd_isa isa);
+
+
+/**
+ * Measures the single-thread throughput of reading, writing and copying a buffer with the scalar kernels, the vector
+ * kernels of simd_isa_in_use, and their non-temporal variants. Copies move the first half of the buffer to the
+ * second half, so every operation touches size_bytes bytes per pass.
+ * @param repeat - the minimal number of 8 byte elements every kernel should process, the kernels are run over the
+ *                 whole buffer as many times as needed to reach it.
+ * @param size_bytes - the size of the buffer in bytes, rounded up to a multiple of 2 * SIMD_BLOCK_SIZE.
+ * @param mem_node - the NUMA node to bind the buffer to, or -1 for first-touch placement.
+ * @param backing - the pages backing the buffer.
+ * @param result - filled with the measured throughputs.
+ * @return 0 on success, -1 on failure.
+ */
+int measure_simd_bandwidth(uint64_t repeat, uint64_t size_bytes, int mem_node, enum page_backing backing,
+                           struct simd_result* result);
+
+#endif
@@ -0,0 +1,95 @@
+#include "statistics.h"
+#include <algorithm>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define OUTLIER_MADS 3.0
+#define MAD_TO_STDDEV 1.4826
+#define BOOTSTRAP_RESAMPLES 1000
+#define BOOTSTRAP_SEED 0x2545F4914F6CDD1DULL
+
+/**
+ * Returns the q-quantile of sorted samples, interpolating linearly between the closest ranks.
+ */
+static double quantile(const double* sorted, int count, double q)
+{
+    double rank = q * (count - 1);
+    int below = (int)rank;
+    if (below + 1 >= count) {
+        return sorted[count - 1];
+    }
+    return sorted[below] + (rank - below) * (sorted[below + 1] - sorted[below]);
+}
+
+/**
+ * Advances a xorshift64 state and returns it, for reproducible bootstrap resampling.
+ */
+static uint64_t xorshift64(uint64_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int compute_trial_statistics(double* samples, int count, struct trial_statistics* stats)
+{
+    std::sort(samples, samples + count);
+    double median = quantile(samples, count, 0.5);
+
+    // Reject the outliers, using the median absolute deviation as a robust estimate of the spread.
+    double* deviations = (double*)malloc(count * sizeof(double));
+    if (deviations == NULL) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        deviations[i] = fabs(samples[i] - median);
+    }
+    std::sort(deviations, deviations + count);
+    double limit = OUTLIER_MADS * MAD_TO_STDDEV * quantile(deviations, count, 0.5);
+    free(deviations);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (limit == 0 || fabs(samples[i] - median) <= limit) {
+            samples[kept++] = samples[i];
+        }
+    }
+
+    double sum = 0;
+    for (int i = 0; i < kept; i++) sum += samples[i];
+    double mean = sum / kept;
+    double squares = 0;
+    for (int i = 0; i < kept; i++) squares += (samples[i] - mean) * (samples[i] - mean);
+
+    stats->kept = kept;
+    stats->median = quantile(samples, kept, 0.5);
+    stats->p5 = quantile(samples, kept, 0.05);
+    stats->p95 = quantile(samples, kept, 0.95);
+    stats->mean = mean;
+    stats->stddev = kept > 1 ? sqrt(squares / (kept - 1)) : 0;
+
+    // Bootstrap the median: resample the kept trials with replacement and take the 2.5% and 97.5% quantiles of the
+    // resampled medians.
+    double* medians = (double*)malloc(BOOTSTRAP_RESAMPLES * sizeof(double));
+    double* resample = (double*)malloc(kept * sizeof(double));
+    if (medians == NULL || resample == NULL) {
+        free(medians);
+        free(resample);
+        return -1;
+    }
+    uint64_t state = BOOTSTRAP_SEED;
+    for (int r = 0; r < BOOTSTRAP_RESAMPLES; r++) {
+        for (int i = 0; i < kept; i++) {
+            resample[i] = samples[xorshift64(&state) % kept];
+        }
+        std::sort(resample, resample + kept);
+        medians[r] = quantile(resample, kept, 0.5);
+    }
+    std::sort(medians, medians + BOOTSTRAP_RESAMPLES);
+    stats->ci_low = quantile(medians, BOOTSTRAP_RESAMPLES, 0.025);
+    stats->ci_high = quantile(medians, BOOTSTRAP_RESAMPLES, 0.975);
+    free(medians);
+    free(resample);
+    return 0;
+}
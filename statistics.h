@@ -0,0 +1,30 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+
+/**
+ * Summary statistics of the independent trials of one measurement point.
+ */
+struct trial_statistics {
+    double median;
+    double p5;          // 5th percentile
+    double p95;         // 95th percentile
+    double mean;
+    double stddev;
+    double ci_low;      // lower bound of the 95% bootstrap confidence interval of the median
+    double ci_high;     // upper bound of the 95% bootstrap confidence interval of the median
+    int kept;           // the number of trials left after rejecting the outliers
+};
+
+
+/**
+ * Computes the statistics of a set of trials. Outliers, trials further than 3 scaled median absolute deviations from
+ * the median, are rejected first, and the statistics are computed over the remaining trials.
+ * @param samples - the results of the trials, reordered in place.
+ * @param count - the number of trials (at least 1).
+ * @param stats - filled with the statistics.
+ * @return 0 on success, -1 on failure.
+ */
+int compute_trial_statistics(double* samples, int count, struct trial_statistics* stats);
+
+#endif
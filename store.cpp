@@ -0,0 +1,100 @@
+#include "memory_latency.h"
+#include "store.h"
+#include "prng.h"
+
+enum store_kind { STORE_ONLY, STORE_RMW, STORE_DIRTY };
+
+/**
+ * Advances the index generator: pseudo-randomly (using a Galois LFSR) like measure_latency, or by one like
+ * measure_sequential_latency.
+ */
+template <bool SEQUENTIAL>
+static inline uint64_t advance(uint64_t rnd)
+{
+    return SEQUENTIAL ? rnd + 1 : lfsr_advance(rnd);
+}
+
+/**
+ * The kernel of one access kind and pattern, so the branches on them are resolved at compile time.
+ */
+template <enum store_kind KIND, bool SEQUENTIAL>
+static struct measurement store_kernel(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    repeat = arr_size > repeat ? arr_size:repeat; // Make sure repeat >= arr_size
+
+    // Baseline measurement - the same index generation, without memory access:
+    uint64_t t0 = timer_now();
+    register uint64_t rnd = 12345;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        register uint64_t index = rnd % arr_size;
+        rnd ^= index & zero;
+        rnd = advance<SEQUENTIAL>(rnd);
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    rnd = (rnd & zero) ^ 12345;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        register uint64_t index = rnd % arr_size;
+        switch (KIND) {
+            case STORE_ONLY:
+                arr[index] = rnd;
+                rnd ^= index & zero;
+                break;
+            case STORE_RMW:
+                arr[index] += 1;
+                rnd ^= index & zero;
+                break;
+            case STORE_DIRTY:
+                rnd ^= arr[index] & zero;
+                arr[index] = i;
+                break;
+        }
+        rnd = advance<SEQUENTIAL>(rnd);
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
+
+    result.baseline = timer_ticks_to_ns(t1 - t0) / repeat;
+    result.access_time = timer_ticks_to_ns(t3 - t2) / repeat;
+    result.rnd = rnd;
+    return result;
+}
+
+struct measurement measure_store_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    return store_kernel<STORE_ONLY, false>(repeat, arr, arr_size, zero);
+}
+
+struct measurement measure_rmw_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    return store_kernel<STORE_RMW, false>(repeat, arr, arr_size, zero);
+}
+
+struct measurement measure_dirty_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero)
+{
+    return store_kernel<STORE_DIRTY, false>(repeat, arr, arr_size, zero);
+}
+
+struct measurement measure_sequential_store_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                    uint64_t zero)
+{
+    return store_kernel<STORE_ONLY, true>(repeat, arr, arr_size, zero);
+}
+
+struct measurement measure_sequential_rmw_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                  uint64_t zero)
+{
+    return store_kernel<STORE_RMW, true>(repeat, arr, arr_size, zero);
+}
+
+struct measurement measure_sequential_dirty_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                    uint64_t zero)
+{
+    return store_kernel<STORE_DIRTY, true>(repeat, arr, arr_size, zero);
+}
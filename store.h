@@ -0,0 +1,32 @@
+#ifndef STORE_H
+#define STORE_H
+
+#include "memory_latency.h"
+
+/**
+ * The write variants of the random and sequential kernels. They visit the same indices as measure_latency and
+ * measure_sequential_latency, and follow the latency_kernel_t signature, returning a struct measurement with the
+ * same fields. Note that they overwrite the content of the array.
+ *
+ * - store: writes every visited element without reading it. The next index doesn't depend on memory, so the stores
+ *          overlap with the index generation, and the offset only grows once write-allocations and write-backs fill
+ *          the store buffer: this is the throughput cost of stores.
+ * - rmw:   increments every visited element (a load and a store to the same element). The next index doesn't depend
+ *          on memory either, so this is the throughput cost of read-modify-write accesses.
+ * - dirty: reads every visited element, and the next index depends on the value read, as in the load kernels. Every
+ *          element read is then written back, so the lines in the cache are dirty, and every miss has to write back the
+ *          line it evicts. Compared with the load kernel, this is the latency cost of dirty evictions.
+ */
+
+struct measurement measure_store_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero);
+struct measurement measure_rmw_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero);
+struct measurement measure_dirty_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size, uint64_t zero);
+
+struct measurement measure_sequential_store_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                    uint64_t zero);
+struct measurement measure_sequential_rmw_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                  uint64_t zero);
+struct measurement measure_sequential_dirty_latency(uint64_t repeat, array_element_t* arr, uint64_t arr_size,
+                                                    uint64_t zero);
+
+#endif
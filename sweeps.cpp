@@ -0,0 +1,1415 @@
+#include "memory_latency.h"
+#include "sweeps.h"
+#include "measure.h"
+#include "pointer_chase.h"
+#include "bandwidth.h"
+#include "loaded_latency.h"
+#include "core_to_core.h"
+#include "latency_histogram.h"
+#include "mlp.h"
+#include "hierarchy.h"
+#include "affinity.h"
+#include "statistics.h"
+#include "allocation.h"
+#include "topology.h"
+#include "init.h"
+#include "store.h"
+#include "simd.h"
+#include "prefetch.h"
+#include "kernel_family.h"
+#include "tlb.h"
+#include "false_sharing.h"
+#include "atomics.h"
+#include "report.h"
+#include <cmath>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_STRIDE_PAGES 16     // the largest stride of the stride mode, in pages
+#define MAX_TLB_POINTS 64       // the largest number of page counts of the tlb mode, per page size
+#define MAX_TLB_LEVELS 4        // the largest number of translation levels the tlb mode reports, per page size
+#define MAX_ASSOC_ADDRESSES 64  // the largest number of conflicting addresses of the assoc mode
+#define MAX_ASSOC_SPACING (2ULL << 20)  // the largest spacing of the assoc mode, one 2MB page
+#define ATOMIC_DRAM_LLC_MULTIPLE 4      // the smallest dram buffer of the atomic mode, in last level caches
+
+/**
+ * Calculates the next array size in the geometric series of sizes to measure.
+ * @param size - the current array size in bytes.
+ * @param factor - the factor of the geometric series.
+ * @return - the next array size in bytes.
+ */
+static uint64_t next_array_size(uint64_t size, double factor)
+{
+    // Calculate next array size using ceiling as specified
+    return ceil(size * factor);
+}
+
+/**
+ * Calculates the next thread count in the series 1, 2, 4, ..., max_threads.
+ * @param threads - the current thread count.
+ * @param max_threads - the last thread count of the series.
+ * @return - the next thread count, greater than max_threads once the series is done.
+ */
+static int next_thread_count(int threads, int max_threads)
+{
+    if (threads < max_threads && threads * 2 > max_threads) {
+        return max_threads;
+    }
+    return threads * 2;
+}
+
+/**
+ * Warns if the threads of a multi-threaded mode outnumber the CPUs they run on, so they share CPUs and their
+ * operations are time-sliced instead of contending.
+ * @param config - the configuration of the run.
+ * @param threads - the number of threads the mode runs at most.
+ */
+static void warn_if_oversubscribed(const struct run_config* config, int threads)
+{
+    cpu_set_t node_cpus;
+    int cpus = config->cpu_node >= 0 && numa_node_cpus(config->cpu_node, &node_cpus) == 0 ? CPU_COUNT(&node_cpus)
+                                                                                           : allowed_cpu_count();
+    if (threads > cpus) {
+        fprintf(stderr, "Warning: %d threads share %d CPUs, their operations are time-sliced\n", threads, cpus);
+    }
+}
+
+/**
+ * Returns the array to measure a working set on: a prefix of the pre-faulted arena in the arena mode, or a fresh
+ * allocation otherwise.
+ * @param config - the configuration of the run.
+ * @param elements - the number of elements of the working set.
+ * @return - the array, or NULL on failure.
+ */
+static array_element_t* acquire_array(const struct run_config* config, uint64_t elements)
+{
+    if (config->arena != NULL) {
+        return config->arena;
+    }
+    return (array_element_t*)alloc_array(elements * sizeof(array_element_t), config->mem_node,
+                                         (enum page_backing)config->backing);
+}
+
+/**
+ * Releases an array returned by acquire_array.
+ * @param config - the configuration of the run.
+ * @param arr - the array to release.
+ * @param elements - the number of elements of the working set, as given to acquire_array.
+ */
+static void release_array(const struct run_config* config, array_element_t* arr, uint64_t elements)
+{
+    if (arr != config->arena) {
+        free_array(arr, elements * sizeof(array_element_t), (enum page_backing)config->backing);
+    }
+}
+
+/**
+ * Runs a latency kernel config->trials independent times on the same array.
+ * @param kernel - the kernel to run.
+ * @param config - the configuration of the run.
+ * @param arr - the array to measure.
+ * @param arr_size - the length of the array arr.
+ * @param stats - filled with the statistics of the offsets (access_time - baseline) of the trials.
+ * @param last - filled with the measurement of the last trial, or NULL.
+ * @return 0 on success, -1 on failure.
+ */
+static int measure_trials(latency_kernel_t kernel, const struct run_config* config, array_element_t* arr,
+                          uint64_t arr_size, struct trial_statistics* stats, struct measurement* last)
+{
+    double* offsets = (double*)malloc(config->trials * sizeof(double));
+    if (offsets == NULL) {
+        return -1;
+    }
+    struct measurement result;
+    for (int t = 0; t < config->trials; t++) {
+        result = kernel(config->repeat, arr, arr_size, config->zero);
+        offsets[t] = result.access_time - result.baseline;
+    }
+    int status = compute_trial_statistics(offsets, config->trials, stats);
+    free(offsets);
+    if (last != NULL) *last = result;
+    return status;
+}
+
+/**
+ * Reports the statistics columns of one kernel: '<kernel>_p5,<kernel>_p95,<kernel>_stddev,<kernel>_ci_low,
+ * <kernel>_ci_high,<kernel>_kept'.
+ * @param kernel - the name of the kernel, the prefix of the column names.
+ * @param stats - the statistics to report.
+ */
+static void print_trial_statistics(const char* kernel, const struct trial_statistics* stats)
+{
+    static const char* const SUFFIXES[] = {"p5", "p95", "stddev", "ci_low", "ci_high"};
+    const double values[] = {stats->p5, stats->p95, stats->stddev, stats->ci_low, stats->ci_high};
+    char name[64];
+    for (int i = 0; i < 5; i++) {
+        snprintf(name, sizeof(name), "%s_%s", kernel, SUFFIXES[i]);
+        report_double(name, values[i], 2);
+    }
+    snprintf(name, sizeof(name), "%s_kept", kernel);
+    report_int(name, stats->kept);
+}
+
+/**
+ * Measures the random, sequential and pointer-chasing access latency for every array size, and prints a line per
+ * size in the format 'mem_size,offset,offset_sequential,offset_chase'. Every offset is the median of config->trials
+ * independent trials; with more than one trial, the statistics of each kernel follow (see print_trial_statistics),
+ * for the random, sequential and pointer-chasing kernels in that order. When a timer was selected, the three offsets
+ * follow in TSC cycles too. When perf counters were requested, the per-access rates of the PERF_COUNTER_COUNT counters
+ * of the random kernel follow, then those of the sequential kernel. When the write kernels were requested, the
+ * offsets of the store, read-modify-write and dirty variants (see store.h) of the random kernel follow, then those of
+ * the sequential kernel. When a page backing was requested, the backing actually obtained is added as a last column.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_latency_sweep(const struct run_config* config)
+{
+    // Start with an array size of 100 bytes
+    uint64_t array_size_bytes = 100;
+
+    // Loop until we reach or exceed the maximum size
+    while (array_size_bytes <= config->max_size) {
+        // Calculate number of elements needed for this array size
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        // Allocate array
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+
+        // Initialize array with pseudo-random values, deterministic for the size whatever the number of threads
+        if (fill_random_parallel(arr, array_size_elements, array_size_bytes, config->init_threads,
+                                 config->cpu_node) != 0) {
+            fprintf(stderr, "Error: Failed to initialize the array\n");
+            release_array(config, arr, array_size_elements);
+            return -1;
+        }
+
+        // Run measurements...
+        struct trial_statistics random_stats, sequential_stats, chase_stats;
+        struct measurement random_result, sequential_result;
+        int status = measure_trials(measure_latency, config, arr, array_size_elements, &random_stats,
+                                    &random_result);
+        if (status == 0) {
+            status = measure_trials(measure_sequential_latency, config, arr, array_size_elements, &sequential_stats,
+                                    &sequential_result);
+        }
+
+        // The write variants, medians only (they overwrite the array, so they run after the load kernels)
+        static const latency_kernel_t STORE_KERNELS[] = {
+            measure_store_latency, measure_rmw_latency, measure_dirty_latency,
+            measure_sequential_store_latency, measure_sequential_rmw_latency, measure_sequential_dirty_latency,
+        };
+        const int store_kernel_count = sizeof(STORE_KERNELS) / sizeof(STORE_KERNELS[0]);
+        double store_offsets[store_kernel_count];
+        for (int k = 0; status == 0 && config->stores && k < store_kernel_count; k++) {
+            struct trial_statistics store_stats;
+            status = measure_trials(STORE_KERNELS[k], config, arr, array_size_elements, &store_stats, NULL);
+            store_offsets[k] = store_stats.median;
+        }
+
+        // Overwrite the array with a random cycle for the dependent-load measurement
+        if (status == 0) {
+            build_random_cycle(arr, array_size_elements, array_size_bytes);
+            status = measure_trials(measure_pointer_chase_latency, config, arr, array_size_elements, &chase_stats,
+                                    NULL);
+        }
+        if (status != 0) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            release_array(config, arr, array_size_elements);
+            return -1;
+        }
+
+        // Offsets are the medians of the trials
+        double random_offset = random_stats.median;
+        double sequential_offset = sequential_stats.median;
+        double chase_offset = chase_stats.median;
+
+        // Print results, with the trial statistics when there are several trials, in TSC cycles too when a timer
+        // was selected, with the per-access perf counters when requested, and with the page backing that was
+        // actually obtained when one was requested
+        report_begin("latency", false);
+        report_uint("mem_size", array_size_bytes);
+        report_double("offset", random_offset, 2);
+        report_double("offset_sequential", sequential_offset, 2);
+        report_double("offset_chase", chase_offset, 2);
+        if (config->trials > 1) {
+            print_trial_statistics("random", &random_stats);
+            print_trial_statistics("sequential", &sequential_stats);
+            print_trial_statistics("chase", &chase_stats);
+        }
+        if (config->timer >= 0) {
+            report_double("cycles", ns_to_cycles(random_offset), 2);
+            report_double("cycles_sequential", ns_to_cycles(sequential_offset), 2);
+            report_double("cycles_chase", ns_to_cycles(chase_offset), 2);
+        }
+        if (config->perf) {
+            char name[64];
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                snprintf(name, sizeof(name), "random_%s", perf_counter_name(c));
+                report_double(name, random_result.counters[c], 3);
+            }
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                snprintf(name, sizeof(name), "sequential_%s", perf_counter_name(c));
+                report_double(name, sequential_result.counters[c], 3);
+            }
+        }
+        if (config->stores) {
+            static const char* const STORE_NAMES[] = {
+                "store", "rmw", "dirty", "store_sequential", "rmw_sequential", "dirty_sequential",
+            };
+            for (int k = 0; k < store_kernel_count; k++) report_double(STORE_NAMES[k], store_offsets[k], 2);
+        }
+        if (config->backing != BACKING_DEFAULT) {
+            char backing[32];
+            report_string("backing", describe_backing(arr, backing, sizeof(backing)));
+        }
+        report_end();
+
+        // Free the array
+        release_array(config, arr, array_size_elements);
+
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Measures the STREAM bandwidth for every array size and every thread count 1, 2, 4, ... up to config->threads, and
+ * prints a line per (size, thread count) in the format 'mem_size,threads,copy,scale,add,triad' (GB/s).
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_bandwidth_sweep(const struct run_config* config)
+{
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        for (int threads = 1; threads <= config->threads; threads = next_thread_count(threads, config->threads)) {
+            struct bandwidth_result result;
+            if (measure_bandwidth(config->repeat, array_size_bytes, threads, config->mem_node, config->cpu_node,
+                                  &result) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory or start the bandwidth threads\n");
+                return -1;
+            }
+            report_begin("bandwidth", false);
+            report_uint("mem_size", array_size_bytes);
+            report_int("threads", threads);
+            report_double("copy", result.copy, 2);
+            report_double("scale", result.scale, 2);
+            report_double("add", result.add, 2);
+            report_double("triad", result.triad, 2);
+            report_end();
+        }
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Measures the single-thread throughput of the streaming read, write and copy kernels for every array size, with the
+ * scalar kernels, the vector kernels of the widest instruction set the CPU supports, and their non-temporal variants.
+ * Prints a header line naming the columns after the instruction set, then a line per size in the format
+ * 'mem_size,read_scalar,read_<isa>,read_<isa>_nt,write_scalar,...,copy_<isa>_nt' (GB/s).
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_simd_sweep(const struct run_config* config)
+{
+    static const char* const OP_NAMES[SIMD_OP_COUNT] = {"read", "write", "copy"};
+    const char* isa = simd_isa_name(simd_isa_in_use);
+
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        struct simd_result result;
+        if (measure_simd_bandwidth(config->repeat, array_size_bytes, config->mem_node,
+                                   (enum page_backing)config->backing, &result) != 0) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        report_begin("simd", true);
+        report_uint("mem_size", array_size_bytes);
+        for (int op = 0; op < SIMD_OP_COUNT; op++) {
+            char name[64];
+            snprintf(name, sizeof(name), "%s_scalar", OP_NAMES[op]);
+            report_double(name, result.bandwidth[op][PATH_SCALAR], 2);
+            snprintf(name, sizeof(name), "%s_%s", OP_NAMES[op], isa);
+            report_double(name, result.bandwidth[op][PATH_VECTOR], 2);
+            snprintf(name, sizeof(name), "%s_%s_nt", OP_NAMES[op], isa);
+            report_double(name, result.bandwidth[op][PATH_NT], 2);
+        }
+        report_end();
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * The injection delays swept by the loaded latency mode when no single delay is given, from the heaviest load to an
+ * almost idle system.
+ */
+static const uint64_t LOADED_LATENCY_DELAYS[] = {0, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 50000};
+
+/**
+ * Measures the pointer-chasing latency for every array size under every injection delay of the background traffic,
+ * and prints a line per (size, delay) in the format 'mem_size,threads,delay,bandwidth,offset_chase'. Plotting
+ * offset_chase against bandwidth for a fixed size gives the latency-vs-bandwidth curve.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_loaded_latency_sweep(const struct run_config* config)
+{
+    // The traffic threads stream over a buffer of max_size bytes, so it's as far from the caches as the sweep goes.
+    char* traffic = (char*)alloc_array(config->max_size, config->mem_node, (enum page_backing)config->backing);
+    if (traffic == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return -1;
+    }
+    memset(traffic, 1, config->max_size);
+    warn_if_oversubscribed(config, config->threads + 1);  // The traffic threads and the latency thread
+
+    const uint64_t* delays = LOADED_LATENCY_DELAYS;
+    size_t delay_count = sizeof(LOADED_LATENCY_DELAYS) / sizeof(LOADED_LATENCY_DELAYS[0]);
+    uint64_t single_delay = config->delay;
+    if (config->delay >= 0) {
+        delays = &single_delay;
+        delay_count = 1;
+    }
+
+    int status = 0;
+    uint64_t array_size_bytes = 100;
+    while (status == 0 && array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            status = -1;
+            break;
+        }
+        build_random_cycle(arr, array_size_elements, array_size_bytes);
+
+        for (size_t d = 0; d < delay_count; d++) {
+            struct loaded_latency_result result;
+            if (measure_loaded_latency(config->repeat, arr, array_size_elements, config->zero, traffic,
+                                       config->max_size, config->threads, (enum traffic_type)config->traffic,
+                                       delays[d], config->cpu_node, &result) != 0) {
+                fprintf(stderr, "Error: Failed to start traffic threads\n");
+                status = -1;
+                break;
+            }
+            report_begin("loaded", false);
+            report_uint("mem_size", array_size_bytes);
+            report_int("threads", config->threads);
+            report_uint("delay", delays[d]);
+            report_double("bandwidth", result.bandwidth, 2);
+            report_double("offset_chase", result.latency.access_time - result.latency.baseline, 2);
+            report_end();
+        }
+
+        release_array(config, arr, array_size_elements);
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    free_array(traffic, config->max_size, (enum page_backing)config->backing);
+    return status;
+}
+
+/**
+ * Samples the pointer-chasing latency in batches of config->batch dependent accesses for every array size, and
+ * prints a line per size in the format 'mem_size,p50,p90,p99,p99.9,max', the per-access latency (ns) percentiles.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_histogram_sweep(const struct run_config* config)
+{
+    struct latency_histogram* histogram = (struct latency_histogram*)malloc(sizeof(struct latency_histogram));
+    if (histogram == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return -1;
+    }
+    // Converts a batch time in timer ticks to the latency of a single access in ns.
+    const double ns_per_access_tick = timer_ticks_to_ns(1) / config->batch;
+
+    int status = 0;
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            status = -1;
+            break;
+        }
+        build_random_cycle(arr, array_size_elements, array_size_bytes);
+        measure_latency_histogram(config->repeat, arr, array_size_elements, config->zero, config->batch, histogram);
+
+        report_begin("histogram", false);
+        report_uint("mem_size", array_size_bytes);
+        report_double("p50", histogram_quantile(histogram, 0.5) * ns_per_access_tick, 2);
+        report_double("p90", histogram_quantile(histogram, 0.9) * ns_per_access_tick, 2);
+        report_double("p99", histogram_quantile(histogram, 0.99) * ns_per_access_tick, 2);
+        report_double("p99.9", histogram_quantile(histogram, 0.999) * ns_per_access_tick, 2);
+        report_double("max", histogram->max * ns_per_access_tick, 2);
+        report_end();
+
+        release_array(config, arr, array_size_elements);
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    free(histogram);
+    return status;
+}
+
+/**
+ * Measures the memory-level parallelism for every array size: runs 1, 2, ..., config->chains interleaved
+ * pointer-chasing chains and prints a line per (size, chains) in the format 'mem_size,chains,offset,bandwidth', where
+ * offset is the effective latency per access (ns) and bandwidth the rate of accessed cache lines (GB/s).
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_mlp_sweep(const struct run_config* config)
+{
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        build_random_cycle(arr, array_size_elements, array_size_bytes);
+
+        for (int chains = 1; chains <= config->chains; chains++) {
+            struct measurement result = measure_mlp_latency(config->repeat, arr, array_size_elements, config->zero,
+                                                            chains);
+            report_begin("mlp", false);
+            report_uint("mem_size", array_size_bytes);
+            report_int("chains", chains);
+            report_double("offset", result.access_time - result.baseline, 2);
+            report_double("bandwidth", CACHE_LINE_SIZE / result.access_time, 2);
+            report_end();
+        }
+
+        release_array(config, arr, array_size_elements);
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Measures the latency of a strided walk for every (array size, stride) point of a grid, Saavedra-style: the sizes
+ * are the geometric series of the other modes, and the strides are the powers of two from one element (8 bytes) to
+ * MAX_STRIDE_PAGES pages. Every walk is a dependent chain through the elements 0, stride, 2 * stride, ..., so the
+ * cache line size, the reach of the hardware prefetchers and the cost of crossing pages show up as steps along the
+ * stride axis. Prints a header line 'mem_size,<stride_1>,<stride_2>,...' (strides in bytes), then a line per size
+ * with the offset of every stride, as the median of config->trials trials; strides that don't fit twice in the array
+ * are left empty.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_stride_sweep(const struct run_config* config)
+{
+    const uint64_t max_stride = MAX_STRIDE_PAGES * (uint64_t)sysconf(_SC_PAGESIZE);
+
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+
+        int status = 0;
+        report_begin("stride", true);
+        report_uint("mem_size", array_size_bytes);
+        for (uint64_t stride = sizeof(array_element_t); stride <= max_stride; stride *= 2) {
+            uint64_t stride_elements = stride / sizeof(array_element_t);
+            char name[32];
+            snprintf(name, sizeof(name), "%lu", stride);
+            if (stride_elements * 2 > array_size_elements) {
+                report_empty(name);
+                continue;
+            }
+            struct trial_statistics stats;
+            build_stride_cycle(arr, array_size_elements, stride_elements);
+            status = measure_trials(measure_pointer_chase_latency, config, arr, array_size_elements, &stats, NULL);
+            if (status != 0) break;
+            report_double(name, stats.median, 2);
+        }
+        report_end();
+
+        release_array(config, arr, array_size_elements);
+        if (status != 0) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Sweeps the software prefetch distance of the random kernel: for every array size and every distance 1, 2, 4, ...
+ * up to MAX_PREFETCH_DISTANCE, measures the kernel with prefetches of each locality hint, and prints a line in the
+ * format 'mem_size,distance,gain_t0,gain_t1,gain_t2,gain_nta', where every gain is the time per access of the plain
+ * measure_latency loop divided by the time per access with the prefetches (above 1 means faster).
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_prefetch_sweep(const struct run_config* config)
+{
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        if (fill_random_parallel(arr, array_size_elements, array_size_bytes, config->init_threads,
+                                 config->cpu_node) != 0) {
+            fprintf(stderr, "Error: Failed to initialize the array\n");
+            release_array(config, arr, array_size_elements);
+            return -1;
+        }
+
+        struct measurement plain = measure_latency(config->repeat, arr, array_size_elements, config->zero);
+        for (int distance = 1; distance <= MAX_PREFETCH_DISTANCE; distance *= 2) {
+            static const char* const HINT_NAMES[PREFETCH_HINT_COUNT] = {"gain_t0", "gain_t1", "gain_t2", "gain_nta"};
+            report_begin("prefetch", false);
+            report_uint("mem_size", array_size_bytes);
+            report_int("distance", distance);
+            for (int hint = 0; hint < PREFETCH_HINT_COUNT; hint++) {
+                struct measurement result = measure_prefetch_latency(config->repeat, arr, array_size_elements,
+                                                                     config->zero, (enum prefetch_hint)hint,
+                                                                     distance);
+                report_double(HINT_NAMES[hint], plain.access_time / result.access_time, 2);
+            }
+            report_end();
+        }
+
+        release_array(config, arr, array_size_elements);
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Measures the template kernel family (see kernel_family.h) for every array size, record size and unroll factor,
+ * and prints a line per combination in the format 'mem_size,element_size,unroll,offset,offset_sequential', where the
+ * offsets are per record access, as the medians of config->trials trials. Record sizes larger than the array are
+ * skipped.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_family_sweep(const struct run_config* config)
+{
+    uint64_t array_size_bytes = 100;
+    while (array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            return -1;
+        }
+        if (fill_random_parallel(arr, array_size_elements, array_size_bytes, config->init_threads,
+                                 config->cpu_node) != 0) {
+            fprintf(stderr, "Error: Failed to initialize the array\n");
+            release_array(config, arr, array_size_elements);
+            return -1;
+        }
+
+        for (int e = 0; e < FAMILY_ELEMENT_SIZE_COUNT; e++) {
+            if ((uint64_t)FAMILY_ELEMENT_SIZES[e] > array_size_elements * sizeof(array_element_t)) continue;
+            for (int u = 0; u < FAMILY_UNROLL_COUNT; u++) {
+                struct trial_statistics random_stats, sequential_stats;
+                if (measure_trials(select_family_kernel(FAMILY_ELEMENT_SIZES[e], FAMILY_UNROLLS[u], PATTERN_RANDOM),
+                                   config, arr, array_size_elements, &random_stats, NULL) != 0 ||
+                    measure_trials(select_family_kernel(FAMILY_ELEMENT_SIZES[e], FAMILY_UNROLLS[u],
+                                                        PATTERN_SEQUENTIAL),
+                                   config, arr, array_size_elements, &sequential_stats, NULL) != 0) {
+                    fprintf(stderr, "Error: Failed to allocate memory\n");
+                    release_array(config, arr, array_size_elements);
+                    return -1;
+                }
+                report_begin("family", false);
+                report_uint("mem_size", array_size_bytes);
+                report_int("element_size", FAMILY_ELEMENT_SIZES[e]);
+                report_int("unroll", FAMILY_UNROLLS[u]);
+                report_double("offset", random_stats.median, 2);
+                report_double("offset_sequential", sequential_stats.median, 2);
+                report_end();
+            }
+        }
+
+        release_array(config, arr, array_size_elements);
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    return 0;
+}
+
+/**
+ * Infers the cache hierarchy from the pointer-chasing latency curve: measures every array size (as the median of
+ * config->trials trials), detects the plateaus of the curve, and prints a line per level in the format
+ * 'level,detected_size,latency,sysfs_size', where sysfs_size is the size of the same level reported by
+ * /sys/devices/system/cpu/cpu<N>/cache for the measuring CPU (empty if unknown). The last plateau is printed as the
+ * 'memory' level, without sizes.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_hierarchy_detection(const struct run_config* config)
+{
+    int cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 0) : allowed_cpu(0);
+    pin_current_thread(cpu);
+
+    int capacity = 64, count = 0;
+    uint64_t* sizes = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    double* latencies = (double*)malloc(capacity * sizeof(double));
+    int status = sizes != NULL && latencies != NULL ? 0 : -1;
+    uint64_t array_size_bytes = 100;
+    while (status == 0 && array_size_bytes <= config->max_size) {
+        uint64_t array_size_elements = array_size_bytes / sizeof(array_element_t);
+        if (array_size_elements == 0) array_size_elements = 1;  // Ensure at least one element
+
+        array_element_t* arr = acquire_array(config, array_size_elements);
+        if (arr == NULL) {
+            status = -1;
+            break;
+        }
+        build_random_cycle(arr, array_size_elements, array_size_bytes);
+        struct trial_statistics stats;
+        status = measure_trials(measure_pointer_chase_latency, config, arr, array_size_elements, &stats, NULL);
+        release_array(config, arr, array_size_elements);
+        if (status != 0) {
+            break;
+        }
+
+        if (count == capacity) {
+            // On failure realloc leaves the old buffer allocated, so it's kept to be freed below.
+            uint64_t* grown_sizes = (uint64_t*)realloc(sizes, 2 * capacity * sizeof(uint64_t));
+            if (grown_sizes != NULL) sizes = grown_sizes;
+            double* grown_latencies = (double*)realloc(latencies, 2 * capacity * sizeof(double));
+            if (grown_latencies != NULL) latencies = grown_latencies;
+            if (grown_sizes == NULL || grown_latencies == NULL) {
+                status = -1;
+                break;
+            }
+            capacity *= 2;
+        }
+        sizes[count] = array_size_bytes;
+        latencies[count] = stats.median;
+        count++;
+        array_size_bytes = next_array_size(array_size_bytes, config->factor);
+    }
+    if (status != 0) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        free(sizes);
+        free(latencies);
+        return -1;
+    }
+
+    struct detected_level levels[MAX_CACHE_LEVELS + 1];
+    int detected = detect_cache_levels(sizes, latencies, count, levels, MAX_CACHE_LEVELS + 1);
+    struct cache_info caches[MAX_CACHE_LEVELS];
+    int known = read_cache_info(cpu, caches, MAX_CACHE_LEVELS);
+
+    for (int l = 0; l < detected; l++) {
+        char level[16];
+        report_begin("hierarchy", true);
+        if (l == detected - 1 && detected > 1) {
+            report_string("level", "memory");
+            report_empty("detected_size");
+        } else {
+            snprintf(level, sizeof(level), "L%d", l < known ? caches[l].level : l + 1);
+            report_string("level", level);
+            report_uint("detected_size", levels[l].size);
+        }
+        report_double("latency", levels[l].latency, 2);
+        if (l < known && !(l == detected - 1 && detected > 1)) {
+            report_uint("sysfs_size", caches[l].size);
+        } else {
+            report_empty("sysfs_size");
+        }
+        report_end();
+    }
+    if (detected - 1 != known) {
+        fprintf(stderr, "Warning: detected %d cache levels, sysfs reports %d\n", detected - 1, known);
+    }
+
+    free(sizes);
+    free(latencies);
+    return 0;
+}
+
+/**
+ * Measures the cache line transfer latency between every ordered pair of allowed CPUs and prints it as a CSV matrix:
+ * a header line 'cpu,<cpu_0>,<cpu_1>,...' followed by a line '<cpu_i>,latency_i_0,latency_i_1,...' per CPU, where
+ * latency_i_j (ns) is measured with the initiating thread on cpu_i and the responder on cpu_j. The diagonal is 0.
+ * @param config - the configuration of the run, only repeat (the number of round trips per pair) is used.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_core_to_core_matrix(const struct run_config* config)
+{
+    int cpus = allowed_cpu_count();
+    for (int i = 0; i < cpus; i++) {
+        report_begin("c2c", true);
+        report_int("cpu", allowed_cpu(i));
+        for (int j = 0; j < cpus; j++) {
+            double latency = 0;
+            if (i != j) {
+                latency = measure_core_to_core_latency(config->repeat, allowed_cpu(i), allowed_cpu(j));
+                if (latency < 0) {
+                    fprintf(stderr, "\nError: Failed to run threads on CPUs %d and %d\n", allowed_cpu(i),
+                            allowed_cpu(j));
+                    return -1;
+                }
+            }
+            char name[16];
+            snprintf(name, sizeof(name), "%d", allowed_cpu(j));
+            report_double(name, latency, 2);
+        }
+        report_end();
+    }
+    return 0;
+}
+
+/**
+ * Reports a NUMA node x node matrix as the table <title>: a header line '<title>,<mem_node_0>,<mem_node_1>,...'
+ * followed by a line '<cpu_node_i>,value_i_0,value_i_1,...' per node.
+ * @param title - the name of the matrix, printed in the top-left cell.
+ * @param values - the values, row-major by CPU node.
+ * @param nodes - the number of NUMA nodes.
+ */
+static void print_numa_matrix(const char* title, const double* values, int nodes)
+{
+    for (int i = 0; i < nodes; i++) {
+        report_begin(title, true);
+        report_int(title, numa_node_id(i));
+        for (int j = 0; j < nodes; j++) {
+            char name[16];
+            snprintf(name, sizeof(name), "%d", numa_node_id(j));
+            report_double(name, values[i * nodes + j], 2);
+        }
+        report_end();
+    }
+}
+
+/**
+ * Measures, for every pair of NUMA nodes, the pointer-chasing latency and the triad bandwidth of a max_size array
+ * bound to one node, accessed by threads running on the other. Prints two node x node matrices (see
+ * print_numa_matrix): 'latency' (ns) and 'bandwidth' (triad GB/s with config->threads threads). A machine without
+ * NUMA support gives 1x1 matrices.
+ * @param config - the configuration of the run, factor is unused.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_numa_matrix(const struct run_config* config)
+{
+    int nodes = numa_node_count();
+    double* latency = (double*)malloc(nodes * nodes * sizeof(double));
+    double* bandwidth = (double*)malloc(nodes * nodes * sizeof(double));
+    uint64_t array_size_elements = config->max_size / sizeof(array_element_t);
+    uint64_t array_bytes = array_size_elements * sizeof(array_element_t);
+    int status = (latency == NULL || bandwidth == NULL) ? -1 : 0;
+
+    for (int i = 0; status == 0 && i < nodes; i++) {
+        if (run_on_numa_node(numa_node_id(i)) != 0) {
+            fprintf(stderr, "Error: Failed to run on NUMA node %d\n", numa_node_id(i));
+            status = -1;
+            break;
+        }
+        for (int j = 0; j < nodes; j++) {
+            array_element_t* arr = (array_element_t*)alloc_array(array_bytes, numa_node_id(j),
+                                                                 (enum page_backing)config->backing);
+            if (arr == NULL) {
+                fprintf(stderr, "Error: Failed to allocate memory on NUMA node %d\n", numa_node_id(j));
+                status = -1;
+                break;
+            }
+            build_random_cycle(arr, array_size_elements, array_bytes);
+            struct measurement chase_result = measure_pointer_chase_latency(config->repeat, arr, array_size_elements,
+                                                                            config->zero);
+            latency[i * nodes + j] = chase_result.access_time - chase_result.baseline;
+            free_array(arr, array_bytes, (enum page_backing)config->backing);
+
+            struct bandwidth_result result;
+            if (measure_bandwidth(config->repeat, config->max_size, config->threads, numa_node_id(j),
+                                  numa_node_id(i), &result) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory on NUMA node %d or start the bandwidth threads\n",
+                        numa_node_id(j));
+                status = -1;
+                break;
+            }
+            bandwidth[i * nodes + j] = result.triad;
+        }
+    }
+
+    if (status == 0) {
+        print_numa_matrix("latency", latency, nodes);
+        print_numa_matrix("bandwidth", bandwidth, nodes);
+    }
+    free(latency);
+    free(bandwidth);
+    return status;
+}
+
+/**
+ * Returns the huge page backing of the modes that need physically contiguous or huge pages: the explicit 2m or 1g
+ * backing if one was selected, transparent huge pages otherwise.
+ * @param config - the configuration of the run.
+ * @return - the page backing.
+ */
+static enum page_backing huge_page_backing(const struct run_config* config)
+{
+    return (config->backing == BACKING_2M || config->backing == BACKING_1G) ? (enum page_backing)config->backing
+                                                                             : BACKING_THP;
+}
+
+/**
+ * Runs measure_page_walk_latency config->trials independent times on the same array.
+ * @param config - the configuration of the run.
+ * @param arr - the array to measure.
+ * @param pages - the number of pages of the array, a power of two.
+ * @param page_size - the size of the pages of the array in bytes.
+ * @param last - filled with the measurement of the last trial.
+ * @param offset - filled with the median offset (access_time - baseline) of the trials.
+ * @return 0 on success, -1 on failure.
+ */
+static int measure_page_walk_trials(const struct run_config* config, char* arr, uint64_t pages, uint64_t page_size,
+                                    struct measurement* last, double* offset)
+{
+    double* offsets = (double*)malloc(config->trials * sizeof(double));
+    if (offsets == NULL) {
+        return -1;
+    }
+    for (int t = 0; t < config->trials; t++) {
+        *last = measure_page_walk_latency(config->repeat, arr, pages, page_size, config->zero);
+        offsets[t] = last->access_time - last->baseline;
+    }
+    struct trial_statistics stats;
+    int status = compute_trial_statistics(offsets, config->trials, &stats);
+    free(offsets);
+    *offset = stats.median;
+    return status;
+}
+
+/**
+ * Measures the address translation cost of base pages and of huge pages (THP, or the explicit 2m/1g backing if one
+ * was selected), touching one line per page over 1, 2, 4, ... pages (see measure_page_walk_latency). Every page
+ * count is measured on a real array of that many pages, up to max_size bytes, and on an aliased array whose pages
+ * all map one physical page, up to MAX_ALIASED_PAGES pages. Prints a line per page count in the format
+ * 'page_size,pages,span,offset,offset_resident[,resident_<counter>...],backing', with an empty column for a variant
+ * that wasn't measured. The resident offsets only pay for the translation, while the plain ones also miss in the
+ * caches once the lines don't fit.
+ * Then detects the plateaus of the resident curve (the plain one if there's no resident curve, e.g. when no huge
+ * pages are reserved for the aliased arrays) and prints a line per level in the format
+ * 'page_size,level,entries,latency,cost,curve', where the levels are l1_dtlb, stlb, l3_tlb, l4_tlb, ... and walk for
+ * the last one, entries is the largest page count of the plateau (empty for the last one), and cost is the latency
+ * over the l1_dtlb plateau. A curve with a single plateau never left the L1 dTLB, so it only gets an l1_dtlb line,
+ * with empty entries, and a warning.
+ * @param config - the configuration of the run, factor is unused.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_tlb_sweep(const struct run_config* config)
+{
+    int cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 0) : allowed_cpu(0);
+    pin_current_thread(cpu);
+
+    enum page_backing huge_backing = huge_page_backing(config);
+    const uint64_t page_sizes[2] = {(uint64_t)sysconf(_SC_PAGESIZE),
+                                    huge_backing == BACKING_1G ? 1ULL << 30 : 2ULL << 20};
+    const enum page_backing backings[2] = {BACKING_4K, huge_backing};
+
+    struct detected_level levels[2][MAX_TLB_LEVELS];
+    int detected[2];
+    bool resident_curve[2];
+    for (int k = 0; k < 2; k++) {
+        const uint64_t page_size = page_sizes[k];
+        uint64_t sizes[MAX_TLB_POINTS];
+        double offsets[MAX_TLB_POINTS], resident_offsets[MAX_TLB_POINTS];
+        int count = 0, resident_count = 0;
+        for (uint64_t pages = 1; count < MAX_TLB_POINTS &&
+                                 (pages * page_size <= config->max_size || pages <= MAX_ALIASED_PAGES); pages *= 2) {
+            offsets[count] = NAN;
+            resident_offsets[count] = NAN;
+            char backing[32] = "";
+            struct measurement plain, resident;
+            if (pages * page_size <= config->max_size) {
+                char* arr = (char*)alloc_array(pages * page_size, config->mem_node, backings[k]);
+                if (arr == NULL) {
+                    fprintf(stderr, "Error: Failed to allocate memory\n");
+                    return -1;
+                }
+                prefault_array(arr, pages * page_size, false);
+                describe_backing(arr, backing, sizeof(backing));
+                int status = measure_page_walk_trials(config, arr, pages, page_size, &plain, &offsets[count]);
+                free_array(arr, pages * page_size, backings[k]);
+                if (status != 0) {
+                    fprintf(stderr, "Error: Failed to allocate memory\n");
+                    return -1;
+                }
+            }
+            if (pages <= MAX_ALIASED_PAGES) {
+                char* arr = (char*)alloc_aliased_array(pages, page_size, config->mem_node);
+                if (arr != NULL) {
+                    int status = measure_page_walk_trials(config, arr, pages, page_size, &resident,
+                                                          &resident_offsets[count]);
+                    free_aliased_array(arr, pages, page_size);
+                    if (status != 0) {
+                        fprintf(stderr, "Error: Failed to allocate memory\n");
+                        return -1;
+                    }
+                    resident_count++;
+                }
+            }
+
+            bool has_plain = !std::isnan(offsets[count]), has_resident = !std::isnan(resident_offsets[count]);
+            if (!has_plain && !has_resident) {
+                continue;   // beyond max_size, and no huge pages reserved for the aliased array
+            }
+            report_begin("tlb", true);
+            report_uint("page_size", page_size);
+            report_uint("pages", pages);
+            report_uint("span", pages * page_size);
+            if (has_plain) {
+                report_double("offset", offsets[count], 2);
+            } else {
+                report_empty("offset");
+            }
+            if (has_resident) {
+                report_double("offset_resident", resident_offsets[count], 2);
+            } else {
+                report_empty("offset_resident");
+            }
+            if (config->perf) {
+                char name[64];
+                for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                    snprintf(name, sizeof(name), "resident_%s", perf_counter_name(c));
+                    if (has_resident) {
+                        report_double(name, resident.counters[c], 3);
+                    } else {
+                        report_empty(name);
+                    }
+                }
+            }
+            report_string("backing", backing);
+            report_end();
+            sizes[count++] = pages;
+        }
+
+        // Detect on the resident curve, or on the plain one if no aliased array could be allocated.
+        resident_curve[k] = resident_count > 0;
+        double curve[MAX_TLB_POINTS];
+        uint64_t curve_sizes[MAX_TLB_POINTS];
+        int points = 0;
+        for (int i = 0; i < count; i++) {
+            double value = resident_curve[k] ? resident_offsets[i] : offsets[i];
+            if (std::isnan(value)) continue;
+            curve_sizes[points] = sizes[i];
+            curve[points++] = value;
+        }
+        detected[k] = detect_cache_levels(curve_sizes, curve, points, levels[k], MAX_TLB_LEVELS);
+    }
+
+    for (int k = 0; k < 2; k++) {
+        if (detected[k] == 1) {
+            fprintf(stderr, "Warning: a single plateau for %lu byte pages, the sweep didn't get past the L1 dTLB\n",
+                    page_sizes[k]);
+        }
+        for (int l = 0; l < detected[k]; l++) {
+            char level[16];
+            if (l == 0) {
+                snprintf(level, sizeof(level), "l1_dtlb");
+            } else if (l == detected[k] - 1) {
+                snprintf(level, sizeof(level), "walk");
+            } else if (l == 1) {
+                snprintf(level, sizeof(level), "stlb");
+            } else {
+                snprintf(level, sizeof(level), "l%d_tlb", l + 1);
+            }
+            report_begin("tlb_levels", true);
+            report_uint("page_size", page_sizes[k]);
+            report_string("level", level);
+            if (l < detected[k] - 1) {
+                report_uint("entries", levels[k][l].size);
+            } else {
+                report_empty("entries");
+            }
+            report_double("latency", levels[k][l].latency, 2);
+            report_double("cost", levels[k][l].latency - levels[k][0].latency, 2);
+            report_string("curve", resident_curve[k] ? "resident" : "plain");
+            report_end();
+        }
+    }
+    return 0;
+}
+
+/**
+ * The latency curve of the assoc mode for one spacing.
+ */
+struct assoc_curve {
+    uint64_t spacing;                                   // in bytes
+    double offsets[MAX_ASSOC_ADDRESSES];                // the latency (ns) of 1, 2, ... addresses
+    struct detected_level steps[MAX_CACHE_LEVELS + 1];  // the plateaus of the curve, sized in addresses
+    int detected;
+};
+
+/**
+ * Returns whether an assoc curve steps up right after 'addresses' addresses (give or take an eighth).
+ */
+static bool assoc_curve_steps_at(const struct assoc_curve* curve, uint64_t addresses)
+{
+    for (int s = 0; s < curve->detected - 1; s++) {
+        uint64_t distance = curve->steps[s].size > addresses ? curve->steps[s].size - addresses
+                                                             : addresses - curve->steps[s].size;
+        if (distance <= 1 + addresses / 8) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Measures set conflicts: for every spacing 64, 128, ... bytes up to MAX_ASSOC_SPACING (and max_size /
+ * MAX_ASSOC_ADDRESSES), chases a random cycle through K = 1 ... MAX_ASSOC_ADDRESSES addresses that many bytes apart
+ * (see build_spaced_cycle), and prints a line per (spacing, K) in the format 'spacing,addresses,offset'. The array is
+ * backed by huge pages, so spacings up to a huge page keep the physical set index bits.
+ * Once the spacing is a multiple of a cache way (size / ways), all the addresses fall into a single set of that
+ * cache, and the latency steps up after 'ways' addresses. So the steps of the widest spacing give the associativity
+ * of every level, and the smallest spacing from which a level's step stays put gives its way size, and its set
+ * count. Prints a line per inferred level in the format 'level,ways,sets,size,penalty,sysfs_ways,sysfs_sets',
+ * where the level is the sysfs cache with the closest number of ways, or 'unknown' if there's none (usually a set
+ * conflict in the TLBs), penalty is the latency added by going over its ways, and the sysfs columns are those of
+ * that cache. Then prints a line per spacing in the format
+ * 'spacing,conflict_addresses,slowdown,pathological': the number of addresses after which the latency first steps
+ * up (empty if it doesn't), the latency of MAX_ASSOC_ADDRESSES addresses over that of one, and the levels the
+ * spacing maps to a single set, which make it a pathological stride (e.g. 'L1;L2').
+ * Sliced last level caches hash the addresses over their slices, so their sets usually can't be detected.
+ * @param config - the configuration of the run, factor is unused.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_assoc_sweep(const struct run_config* config)
+{
+    int cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 0) : allowed_cpu(0);
+    pin_current_thread(cpu);
+
+    uint64_t max_spacing = MAX_ASSOC_SPACING;
+    while (max_spacing > CACHE_LINE_SIZE && max_spacing * MAX_ASSOC_ADDRESSES > config->max_size) {
+        max_spacing /= 2;
+    }
+    const uint64_t bytes = max_spacing * MAX_ASSOC_ADDRESSES;
+    const enum page_backing backing = huge_page_backing(config);
+    array_element_t* arr = (array_element_t*)alloc_array(bytes, config->mem_node, backing);
+    if (arr == NULL) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return -1;
+    }
+    prefault_array(arr, bytes, false);
+
+    struct assoc_curve curves[64];
+    int count = 0;
+    for (uint64_t spacing = CACHE_LINE_SIZE; spacing <= max_spacing; spacing *= 2) {
+        struct assoc_curve* curve = &curves[count++];
+        curve->spacing = spacing;
+        uint64_t sizes[MAX_ASSOC_ADDRESSES];
+        for (int k = 1; k <= MAX_ASSOC_ADDRESSES; k++) {
+            struct trial_statistics stats;
+            if (build_spaced_cycle(arr, k, spacing / sizeof(array_element_t), spacing + k) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory\n");
+                free_array(arr, bytes, backing);
+                return -1;
+            }
+            if (measure_trials(measure_pointer_chase_latency, config, arr, k, &stats, NULL) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory\n");
+                free_array(arr, bytes, backing);
+                return -1;
+            }
+            sizes[k - 1] = k;
+            curve->offsets[k - 1] = stats.median;
+
+            report_begin("assoc", true);
+            report_uint("spacing", spacing);
+            report_int("addresses", k);
+            report_double("offset", stats.median, 2);
+            report_end();
+        }
+        curve->detected = detect_cache_levels(sizes, curve->offsets, MAX_ASSOC_ADDRESSES, curve->steps,
+                                              MAX_CACHE_LEVELS + 1);
+    }
+    free_array(arr, bytes, backing);
+
+    // Every step of the widest spacing is a level whose sets are all in use by one address each. The levels are
+    // named after the sysfs cache of the same associativity: a step that matches none is usually a set conflict of
+    // the TLBs, as the addresses are also in as many pages.
+    const struct assoc_curve* widest = &curves[count - 1];
+    struct cache_info caches[MAX_CACHE_LEVELS];
+    int known = read_cache_info(cpu, caches, MAX_CACHE_LEVELS);
+    uint64_t way_sizes[MAX_CACHE_LEVELS];
+    char names[MAX_CACHE_LEVELS][16];
+    int levels = widest->detected - 1 < MAX_CACHE_LEVELS ? widest->detected - 1 : MAX_CACHE_LEVELS;
+    for (int l = 0; l < levels; l++) {
+        uint64_t ways = widest->steps[l].size;
+        double penalty = widest->steps[l + 1].latency - widest->steps[l].latency;
+        if (penalty <= 0) {
+            way_sizes[l] = UINT64_MAX;  // noise, not a level: the latency doesn't go up
+            names[l][0] = '\0';
+            continue;
+        }
+        int c = count - 1;
+        while (c > 0 && assoc_curve_steps_at(&curves[c - 1], ways)) c--;
+        way_sizes[l] = curves[c].spacing;
+
+        int match = -1;
+        uint64_t best = 1 + ways / 8;
+        for (int i = 0; i < known; i++) {
+            uint64_t distance = (uint64_t)caches[i].ways > ways ? caches[i].ways - ways : ways - caches[i].ways;
+            if (caches[i].ways > 0 && distance <= best) {
+                match = i;
+                best = distance;
+            }
+        }
+        if (match >= 0) {
+            snprintf(names[l], sizeof(names[l]), "L%d", caches[match].level);
+        } else {
+            if (known > 0) {
+                snprintf(names[l], sizeof(names[l]), "unknown");
+            } else {
+                snprintf(names[l], sizeof(names[l]), "L%d", l + 1);
+            }
+        }
+
+        report_begin("assoc_levels", true);
+        report_string("level", names[l]);
+        report_uint("ways", ways);
+        report_uint("sets", way_sizes[l] / CACHE_LINE_SIZE);
+        report_uint("size", ways * way_sizes[l]);
+        report_double("penalty", penalty, 2);
+        if (match >= 0) {
+            report_int("sysfs_ways", caches[match].ways);
+            report_int("sysfs_sets", caches[match].sets);
+        } else {
+            report_empty("sysfs_ways");
+            report_empty("sysfs_sets");
+        }
+        report_end();
+    }
+
+    for (int c = 0; c < count; c++) {
+        char pathological[64] = "";
+        for (int l = 0; l < levels; l++) {
+            if (curves[c].spacing >= way_sizes[l] && strstr(pathological, names[l]) == NULL &&
+                strlen(pathological) + strlen(names[l]) + 2 <= sizeof(pathological)) {
+                if (pathological[0] != '\0') strcat(pathological, ";");
+                strcat(pathological, names[l]);
+            }
+        }
+        report_begin("assoc_strides", true);
+        report_uint("spacing", curves[c].spacing);
+        if (curves[c].detected > 1) {
+            report_uint("conflict_addresses", curves[c].steps[0].size);
+        } else {
+            report_empty("conflict_addresses");
+        }
+        report_double("slowdown", curves[c].offsets[MAX_ASSOC_ADDRESSES - 1] / curves[c].offsets[0], 2);
+        report_string("pathological", pathological);
+        report_end();
+    }
+    return 0;
+}
+
+/**
+ * Measures false sharing for every thread count 1, 2, 4, ..., config->threads and every layout of the per-thread
+ * variables (see sharing_layout), and prints a line per (thread count, layout) in the format
+ * 'threads,layout,stride,throughput,latency': the updates of all the threads per microsecond, and the average time
+ * (ns) of one update.
+ * @param config - the configuration of the run, max_size and factor are unused.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_sharing_sweep(const struct run_config* config)
+{
+    warn_if_oversubscribed(config, config->threads);
+    for (int threads = 1; threads <= config->threads; threads = next_thread_count(threads, config->threads)) {
+        for (int layout = 0; layout < LAYOUT_COUNT; layout++) {
+            uint64_t stride = sharing_layout_stride((enum sharing_layout)layout);
+            struct sharing_result result;
+            if (measure_false_sharing(config->repeat, threads, stride, config->mem_node, config->cpu_node,
+                                      &result) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory or start the false sharing threads\n");
+                return -1;
+            }
+            report_begin("sharing", false);
+            report_int("threads", threads);
+            report_string("layout", sharing_layout_name((enum sharing_layout)layout));
+            report_uint("stride", stride);
+            report_double("throughput", result.throughput, 2);
+            report_double("latency", result.latency, 2);
+            report_end();
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reports one point of the atomic suite.
+ */
+static void report_atomic(int variant, const char* placement, int threads, const struct atomic_result* result)
+{
+    report_begin("atomic", false);
+    report_string("op", atomic_variant_op_name(variant));
+    report_string("order", atomic_variant_order_name(variant));
+    report_string("placement", placement);
+    report_int("threads", threads);
+    report_double("latency", result->latency, 2);
+    report_double("throughput", result->throughput, 2);
+    report_end();
+}
+
+/**
+ * Measures every variant of the atomic suite (see atomics.h): on one thread with its line in L1 ('l1'), with lines
+ * in the last level cache ('llc', a buffer of half its size, skipped if that fits in the level below) and in memory
+ * ('dram', a max_size buffer, skipped if it's under ATOMIC_DRAM_LLC_MULTIPLE times the last level cache), on lines
+ * modified in another core's cache ('remote', skipped on a single CPU), and with 1, 2, 4, ..., config->threads
+ * threads on one line ('contended'). The buffers are backed by huge pages, so the TLB misses don't add up to the
+ * latencies. Prints a line per point in the format 'op,order,placement,threads,latency,throughput': the average time
+ * (ns) of one operation over the baseline loop, and the operations of all the threads per microsecond.
+ * @param config - the configuration of the run, factor is unused.
+ * @return 0 on success, -1 on failure.
+ */
+static int run_atomic_sweep(const struct run_config* config)
+{
+    int cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 0) : allowed_cpu(0);
+    int owner_cpu = config->cpu_node >= 0 ? numa_node_cpu(config->cpu_node, 1) : allowed_cpu(1);
+    pin_current_thread(cpu);
+    warn_if_oversubscribed(config, config->threads);
+    if (owner_cpu == cpu) {
+        fprintf(stderr, "Warning: a single CPU, the remote placement is skipped\n");
+    }
+
+    // The buffers are rounded down to a power of two number of lines (see measure_atomic_latency), so their sizes
+    // are compared with the caches after the rounding.
+    struct cache_info caches[MAX_CACHE_LEVELS];
+    int known = read_cache_info(cpu, caches, MAX_CACHE_LEVELS);
+    uint64_t llc_size = known > 0 ? caches[known - 1].size : 0;
+    uint64_t llc_bytes = CACHE_LINE_SIZE, dram_bytes = CACHE_LINE_SIZE;
+    while (llc_bytes * 2 <= llc_size / 2) llc_bytes *= 2;
+    while (dram_bytes * 2 <= config->max_size) dram_bytes *= 2;
+    bool measured[] = {true, known > 1 && llc_bytes > caches[known - 2].size,
+                       known > 0 && dram_bytes >= ATOMIC_DRAM_LLC_MULTIPLE * llc_size};
+    if (known == 0) {
+        fprintf(stderr, "Warning: the cache sizes are unknown, the llc and dram placements are skipped\n");
+    } else {
+        if (known == 1) {
+            fprintf(stderr, "Warning: only one cache level is known, the llc placement is skipped\n");
+        } else if (!measured[1]) {
+            fprintf(stderr, "Warning: half the last level cache fits in the level below, the llc placement is "
+                            "skipped\n");
+        }
+        if (!measured[2]) {
+            fprintf(stderr, "Warning: max_size is under %d times the last level cache (%lu bytes), the dram "
+                            "placement is skipped\n", ATOMIC_DRAM_LLC_MULTIPLE, llc_size);
+        }
+    }
+    const enum page_backing backing = huge_page_backing(config);
+    const char* const placements[] = {"l1", "llc", "dram"};
+    const uint64_t placement_bytes[] = {CACHE_LINE_SIZE, llc_bytes, dram_bytes};
+
+    for (int variant = 0; variant < atomic_variant_count(); variant++) {
+        struct atomic_result result;
+        for (int p = 0; p < 3; p++) {
+            if (!measured[p]) continue;
+            if (measure_atomic_latency(variant, config->repeat, placement_bytes[p], config->mem_node, backing,
+                                       config->zero, &result) != 0) {
+                fprintf(stderr, "Error: Failed to allocate memory\n");
+                return -1;
+            }
+            report_atomic(variant, placements[p], 1, &result);
+        }
+        if (owner_cpu != cpu) {
+            if (measure_atomic_remote(variant, config->repeat, cpu, owner_cpu, config->zero, &result) != 0) {
+                fprintf(stderr, "Error: Failed to measure the remote placement\n");
+                return -1;
+            }
+            report_atomic(variant, "remote", 1, &result);
+        }
+        for (int threads = 1; threads <= config->threads; threads = next_thread_count(threads, config->threads)) {
+            if (measure_atomic_contention(variant, config->repeat, threads, config->cpu_node, config->zero,
+                                          &result) != 0) {
+                fprintf(stderr, "Error: Failed to start the contending threads\n");
+                return -1;
+            }
+            report_atomic(variant, "contended", threads, &result);
+        }
+    }
+    return 0;
+}
+
+static const char* const MODE_NAMES[MODE_COUNT] = {
+    "latency", "bandwidth", "loaded", "c2c", "numa", "histogram", "mlp", "hierarchy", "stride", "simd", "prefetch",
+    "family", "tlb", "assoc", "sharing", "atomic"
+};
+
+const char* run_mode_name(enum run_mode mode)
+{
+    return mode >= 0 && mode < MODE_COUNT ? MODE_NAMES[mode] : "unknown";
+}
+
+int parse_run_mode(const char* name)
+{
+    for (int mode = 0; mode < MODE_COUNT; mode++) {
+        if (strcmp(name, MODE_NAMES[mode]) == 0) {
+            return mode;
+        }
+    }
+    return -1;
+}
+
+int run_sweep(const struct run_config* config)
+{
+    switch (config->mode) {
+        case MODE_BANDWIDTH:
+            return run_bandwidth_sweep(config);
+        case MODE_LOADED_LATENCY:
+            return run_loaded_latency_sweep(config);
+        case MODE_CORE_TO_CORE:
+            return run_core_to_core_matrix(config);
+        case MODE_NUMA_MATRIX:
+            return run_numa_matrix(config);
+        case MODE_HISTOGRAM:
+            return run_histogram_sweep(config);
+        case MODE_MLP:
+            return run_mlp_sweep(config);
+        case MODE_HIERARCHY:
+            return run_hierarchy_detection(config);
+        case MODE_STRIDE:
+            return run_stride_sweep(config);
+        case MODE_SIMD:
+            return run_simd_sweep(config);
+        case MODE_PREFETCH:
+            return run_prefetch_sweep(config);
+        case MODE_FAMILY:
+            return run_family_sweep(config);
+        case MODE_TLB:
+            return run_tlb_sweep(config);
+        case MODE_ASSOC:
+            return run_assoc_sweep(config);
+        case MODE_SHARING:
+            return run_sharing_sweep(config);
+        case MODE_ATOMIC:
+            return run_atomic_sweep(config);
+        case MODE_LATENCY:
+        default:
+            return run_latency_sweep(config);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef SWEEPS_H
+#define SWEEPS_H
+
+#include "memory_latency.h"
+
+
+/**
+ * Runs the measurement mode of a configuration over its sizes, and prints its results to stdout in config->output
+ * format (see the documentation of main for the format of every mode). memlat_init must have been called, and the
+ * calling thread already placed on config->cpu_node.
+ * @param config - the configuration of the run.
+ * @return 0 on success, -1 on failure.
+ */
+int run_sweep(const struct run_config* config);
+
+
+/**
+ * Returns the name of a measurement mode, as accepted by the -m option.
+ * @param mode - the mode to name.
+ * @return the name of the mode, or "unknown".
+ */
+const char* run_mode_name(enum run_mode mode);
+
+
+/**
+ * Parses the name of a measurement mode.
+ * @param name - the name of the mode, as printed by run_mode_name.
+ * @return the enum run_mode of the name, or -1 if it names no mode.
+ */
+int parse_run_mode(const char* name);
+
+#endif
@@ -0,0 +1,106 @@
+#include "timer.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#define TSC_CALIBRATION_NS 50000000ULL
+#define CPUID_RDTSCP_BIT (1U << 27)         // in EDX of leaf 0x80000001
+#define CPUID_INVARIANT_TSC_BIT (1U << 8)   // in EDX of leaf 0x80000007
+
+enum timer_backend timer_backend_in_use = TIMER_TIMESPEC;
+static double measured_tsc_ghz = 0;
+static bool tsc_calibrated = false;
+
+/**
+ * Checks with cpuid that the CPU has rdtscp, which read_tsc uses, and an invariant TSC, which ticks at a constant
+ * rate whatever the frequency and power state of the core.
+ * @return - true if the TSC can time the measurements.
+ */
+static bool tsc_supported()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) == 0 || (edx & CPUID_RDTSCP_BIT) == 0) {
+        return false;
+    }
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 || (edx & CPUID_INVARIANT_TSC_BIT) == 0) {
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Reads CLOCK_MONOTONIC_RAW in nano-seconds.
+ */
+static uint64_t monotonic_raw_ns()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+/**
+ * Measures the TSC frequency by counting TSC cycles over a CLOCK_MONOTONIC_RAW interval.
+ * @return - the TSC frequency in GHz, or 0 if there is no usable TSC.
+ */
+static double calibrate_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if (!tsc_supported()) {
+        return 0;
+    }
+    uint64_t ns0 = monotonic_raw_ns();
+    uint64_t tsc0 = read_tsc();
+    uint64_t ns1 = ns0;
+    while (ns1 - ns0 < TSC_CALIBRATION_NS) {
+        ns1 = monotonic_raw_ns();
+    }
+    uint64_t tsc1 = read_tsc();
+    return (double)(tsc1 - tsc0) / (ns1 - ns0);
+#else
+    return 0;
+#endif
+}
+
+int timer_init(enum timer_backend backend)
+{
+    if (backend == TIMER_TSC && tsc_ghz() <= 0) {
+        return -1;
+    }
+    timer_backend_in_use = backend;
+    return 0;
+}
+
+int parse_timer_backend(const char* name)
+{
+    if (strcmp(name, "timespec") == 0) return TIMER_TIMESPEC;
+    if (strcmp(name, "raw") == 0) return TIMER_MONOTONIC_RAW;
+    if (strcmp(name, "tsc") == 0) return TIMER_TSC;
+    return -1;
+}
+
+double tsc_ghz()
+{
+    if (!tsc_calibrated) {
+        measured_tsc_ghz = calibrate_tsc();
+        tsc_calibrated = true;
+    }
+    return measured_tsc_ghz;
+}
+
+double timer_ticks_to_ns(uint64_t ticks)
+{
+    if (timer_backend_in_use == TIMER_TSC) {
+        return ticks / measured_tsc_ghz;
+    }
+    return ticks;
+}
+
+double ns_to_cycles(double ns)
+{
+    return ns * tsc_ghz();
+}
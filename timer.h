@@ -0,0 +1,107 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+/**
+ * The clocks the measurements can be timed with.
+ */
+enum timer_backend {
+    TIMER_TIMESPEC,         // timespec_get(TIME_UTC), wall-clock time that NTP may step
+    TIMER_MONOTONIC_RAW,    // clock_gettime(CLOCK_MONOTONIC_RAW), not adjusted by NTP
+    TIMER_TSC               // the time stamp counter, read with rdtscp and fenced with lfence
+};
+
+
+/**
+ * The backend timer_now reads, set by timer_init.
+ */
+extern enum timer_backend timer_backend_in_use;
+
+
+/**
+ * Selects the timer backend. The TSC backend needs rdtscp and an invariant TSC (checked with cpuid), and calibrates
+ * the TSC frequency against CLOCK_MONOTONIC_RAW; the other backends leave the calibration to the first call of
+ * tsc_ghz or ns_to_cycles, if results are reported in cycles at all.
+ * @param backend - the backend to time the measurements with.
+ * @return 0 on success, -1 if the backend isn't supported on this machine.
+ */
+int timer_init(enum timer_backend backend);
+
+
+/**
+ * Parses the name of a timer backend ('timespec', 'raw' or 'tsc').
+ * @param name - the name to parse.
+ * @return - the timer backend, or -1 if the name is unknown.
+ */
+int parse_timer_backend(const char* name);
+
+
+/**
+ * Returns the frequency of the TSC, calibrating it against CLOCK_MONOTONIC_RAW (for 50ms) on the first call.
+ * @return - the TSC frequency in GHz (TSC cycles per ns), or 0 if the CPU has no rdtscp or no invariant TSC.
+ */
+double tsc_ghz();
+
+
+/**
+ * Converts a difference of two timer_now readings to nano-seconds.
+ * @param ticks - the difference of the readings.
+ * @return - the time in nano-seconds.
+ */
+double timer_ticks_to_ns(uint64_t ticks);
+
+
+/**
+ * Converts nano-seconds to TSC cycles.
+ * @param ns - the time in nano-seconds.
+ * @return - the time in TSC cycles, or 0 if the TSC frequency isn't available.
+ */
+double ns_to_cycles(double ns);
+
+
+/**
+ * Reads the time stamp counter. rdtscp waits for the preceding instructions to finish and the lfence keeps the
+ * following ones from starting before the read.
+ * @return - the TSC value.
+ */
+static inline uint64_t read_tsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int aux;
+    uint64_t tsc = __rdtscp(&aux);
+    _mm_lfence();
+    return tsc;
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * Reads the selected timer backend.
+ * @return - the current time in ticks: nano-seconds for the clock backends, TSC cycles for the TSC backend.
+ */
+static inline uint64_t timer_now()
+{
+    struct timespec t;
+    switch (timer_backend_in_use) {
+        case TIMER_TSC:
+            return read_tsc();
+        case TIMER_MONOTONIC_RAW:
+            clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+            break;
+        case TIMER_TIMESPEC:
+        default:
+            timespec_get(&t, TIME_UTC);
+            break;
+    }
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "memory_latency.h"
+#include "tlb.h"
+#include "prng.h"
+
+struct measurement measure_page_walk_latency(uint64_t repeat, char* arr, uint64_t pages, uint64_t page_size,
+                                             uint64_t zero)
+{
+    repeat = pages > repeat ? pages:repeat; // Make sure repeat >= pages
+
+    // state = 5 * state + 1 (mod pages) has a full period over any power of two
+    const uint64_t mask = pages - 1;
+    const int shift = (__builtin_ctzll(pages) + 1) / 2;
+
+    // Baseline measurement - the same page computation, without the load:
+    uint64_t t0 = timer_now();
+    register uint64_t state = 0;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        uint64_t page = scramble_pow2(state, mask, shift);
+        uint64_t offset = page * page_size + (page % PAGE_WALK_LINES) * CACHE_LINE_SIZE;
+        state = (5 * state + 1 + (offset & zero)) & mask;
+    }
+    uint64_t t1 = timer_now();
+
+    // Memory access measurement, with the perf counters around it. The array holds zeros, so the loaded value only
+    // adds a dependency:
+    struct measurement result;
+    perf_counters_start();
+    uint64_t t2 = timer_now();
+    state &= zero;
+    for (register uint64_t i = 0; i < repeat; i++)
+    {
+        uint64_t page = scramble_pow2(state, mask, shift);
+        uint64_t offset = page * page_size + (page % PAGE_WALK_LINES) * CACHE_LINE_SIZE;
+        state = (5 * state + 1 + *(array_element_t*)(arr + offset)) & mask;
+    }
+    uint64_t t3 = timer_now();
+    perf_counters_stop(repeat, result.counters);
+
+    // Calculate baseline and memory access times:
+    double baseline_per_cycle=timer_ticks_to_ns(t1 - t0)/(repeat);
+    double memory_per_cycle=timer_ticks_to_ns(t3 - t2)/(repeat);
+
+    result.baseline = baseline_per_cycle;
+    result.access_time = memory_per_cycle;
+    result.rnd = state;
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include "memory_latency.h"
+
+#define PAGE_WALK_LINES 64          // the page walk spreads its accesses over the first 64 lines (4KB) of the pages
+#define MAX_ALIASED_PAGES (1 << 15) // the largest number of views of an aliased array, well below vm.max_map_count
+
+
+/**
+ * Measures the average latency of a load that touches exactly one cache line per page, visiting the pages in a
+ * pseudo-random order. The page order comes from a full period LCG over the page numbers, scrambled by a bijection,
+ * and every load feeds the next page number, so the CPU can not overlap consecutive accesses. The loaded line is
+ * line (page % PAGE_WALK_LINES) of its page, so the lines spread over the cache sets. With an aliased array
+ * (alloc_aliased_array) all the lines are the same PAGE_WALK_LINES physical lines, always in L1, and the offset is the
+ * cost of the address translation alone.
+ * @param repeat - the number of times to repeat the measurement for and average on.
+ * @param arr - a zero filled array of 'pages' pages.
+ * @param pages - the number of pages of the array, a power of two.
+ * @param page_size - the size of the pages of the array in bytes, at least PAGE_WALK_LINES cache lines.
+ * @param zero - a variable containing zero in a way that the compiler doesn't "know" it in compilation time.
+ * @return struct measurement containing the measurement with the following fields:
+ *      double baseline - the average time (ns) taken to compute the next page without memory access.
+ *      double access_time - the average time (ns) taken to compute the next page with memory access.
+ *      uint64_t rnd - the last page number, returned to prevent compiler optimizations.
+ *      double counters[] - the per-access counts of the perf counters over the memory access loop (NaN if not open).
+ */
+struct measurement measure_page_walk_latency(uint64_t repeat, char* arr, uint64_t pages, uint64_t page_size,
+                                             uint64_t zero);
+
+#endif
@@ -0,0 +1,200 @@
+#include "topology.h"
+#include "affinity.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NODE_SYSFS_DIR "/sys/devices/system/node"
+#define CPU_SYSFS_DIR "/sys/devices/system/cpu"
+
+/**
+ * Reads a sysfs id list such as "0-3,8,10-11" into a set.
+ * @param path - the path of the sysfs file.
+ * @param set - filled with the ids in the list.
+ * @return - the number of ids read, or -1 if the file can't be read.
+ */
+static int read_id_list(const char* path, cpu_set_t* set)
+{
+    CPU_ZERO(set);
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char text[4096];
+    if (fgets(text, sizeof(text), file) == NULL) {
+        text[0] = '\0';
+    }
+    fclose(file);
+
+    char* p = text;
+    while (*p != '\0' && *p != '\n') {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long id = first; id <= last && id < CPU_SETSIZE; id++) {
+            CPU_SET(id, set);
+        }
+        if (*p == ',') p++;
+    }
+    return CPU_COUNT(set);
+}
+
+/**
+ * Returns the set of online NUMA nodes, read once from sysfs. Without NUMA support this is just node 0.
+ * @return - the set of online node ids.
+ */
+static const cpu_set_t& online_nodes()
+{
+    static const cpu_set_t nodes = []() {
+        cpu_set_t s;
+        if (read_id_list(NODE_SYSFS_DIR "/online", &s) <= 0) {
+            CPU_ZERO(&s);
+            CPU_SET(0, &s);
+        }
+        return s;
+    }();
+    return nodes;
+}
+
+int numa_node_count()
+{
+    return CPU_COUNT(&online_nodes());
+}
+
+int numa_node_id(int index)
+{
+    const cpu_set_t& nodes = online_nodes();
+    for (int node = 0; node < CPU_SETSIZE; node++) {
+        if (CPU_ISSET(node, &nodes) && index-- == 0) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+int numa_node_cpus(int node, cpu_set_t* set)
+{
+    char path[128];
+    snprintf(path, sizeof(path), NODE_SYSFS_DIR "/node%d/cpulist", node);
+    cpu_set_t node_set;
+    if (read_id_list(path, &node_set) <= 0) {
+        if (numa_node_count() > 1) {
+            return -1;
+        }
+        // No NUMA information: the single node holds every allowed CPU.
+        CPU_ZERO(&node_set);
+        for (int i = 0; i < allowed_cpu_count(); i++) {
+            CPU_SET(allowed_cpu(i), &node_set);
+        }
+    }
+
+    CPU_ZERO(set);
+    for (int i = 0; i < allowed_cpu_count(); i++) {
+        if (CPU_ISSET(allowed_cpu(i), &node_set)) {
+            CPU_SET(allowed_cpu(i), set);
+        }
+    }
+    if (CPU_COUNT(set) == 0) {
+        *set = node_set;
+    }
+    return 0;
+}
+
+int numa_node_cpu(int node, int slot)
+{
+    cpu_set_t set;
+    if (node < 0 || numa_node_cpus(node, &set) != 0) {
+        return allowed_cpu(slot);
+    }
+    int wanted = slot % CPU_COUNT(&set);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set) && wanted-- == 0) {
+            return cpu;
+        }
+    }
+    return allowed_cpu(slot);
+}
+
+int run_on_numa_node(int node)
+{
+    cpu_set_t set;
+    if (numa_node_cpus(node, &set) != 0) {
+        return -1;
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+/**
+ * Reads the first line of a sysfs file.
+ * @return 0 on success, -1 if the file can't be read.
+ */
+static int read_sysfs_line(const char* path, char* line, size_t size)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char* read = fgets(line, size, file);
+    fclose(file);
+    if (read == NULL) {
+        return -1;
+    }
+    line[strcspn(line, "\n")] = '\0';
+    return 0;
+}
+
+/**
+ * Reads an integer sysfs attribute of a cache, 0 if it's missing.
+ */
+static long read_cache_attribute(int cpu, int index, const char* name)
+{
+    char path[256], line[64];
+    snprintf(path, sizeof(path), CPU_SYSFS_DIR "/cpu%d/cache/index%d/%s", cpu, index, name);
+    if (read_sysfs_line(path, line, sizeof(line)) != 0) {
+        return 0;
+    }
+    char* unit;
+    long value = strtol(line, &unit, 10);
+    if (*unit == 'K') value <<= 10;
+    else if (*unit == 'M') value <<= 20;
+    else if (*unit == 'G') value <<= 30;
+    return value;
+}
+
+int read_cache_info(int cpu, struct cache_info* caches, int max_caches)
+{
+    int count = 0;
+    for (int index = 0; count < max_caches; index++) {
+        char path[256], type[32];
+        snprintf(path, sizeof(path), CPU_SYSFS_DIR "/cpu%d/cache/index%d/type", cpu, index);
+        if (read_sysfs_line(path, type, sizeof(type)) != 0) {
+            break;
+        }
+        if (strcmp(type, "Instruction") == 0) {
+            continue;
+        }
+        struct cache_info cache;
+        cache.level = (int)read_cache_attribute(cpu, index, "level");
+        cache.size = read_cache_attribute(cpu, index, "size");
+        cache.ways = (int)read_cache_attribute(cpu, index, "ways_of_associativity");
+        cache.line_size = (int)read_cache_attribute(cpu, index, "coherency_line_size");
+        cache.sets = (int)read_cache_attribute(cpu, index, "number_of_sets");
+
+        // Keep the caches sorted by level
+        int position = count;
+        while (position > 0 && caches[position - 1].level > cache.level) {
+            caches[position] = caches[position - 1];
+            position--;
+        }
+        caches[position] = cache;
+        count++;
+    }
+    return count;
+}
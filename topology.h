@@ -0,0 +1,74 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <sched.h>
+#include <stdint.h>
+
+#define MAX_CACHE_LEVELS 8
+
+
+/**
+ * The description of one data (or unified) cache, as reported by sysfs.
+ */
+struct cache_info {
+    int level;
+    uint64_t size;          // in bytes
+    int ways;               // the associativity, 0 if unknown (e.g. fully associative)
+    int line_size;          // in bytes
+    int sets;
+};
+
+
+/**
+ * Returns the number of online NUMA nodes. Machines (or kernels) without NUMA support are reported as a single node.
+ * @return - the number of online NUMA nodes (at least 1).
+ */
+int numa_node_count();
+
+
+/**
+ * Maps an index in [0, numa_node_count()) to the id of an online NUMA node, node ids may have gaps.
+ * @param index - the index of the node.
+ * @return - the id of the node.
+ */
+int numa_node_id(int index);
+
+
+/**
+ * Fills the set of CPUs of a NUMA node this process is allowed to run on. If the process may not run on any of them,
+ * all the CPUs of the node are returned.
+ * @param node - the id of the node.
+ * @param set - filled with the CPUs of the node.
+ * @return 0 on success, -1 if the node has no CPUs.
+ */
+int numa_node_cpus(int node, cpu_set_t* set);
+
+
+/**
+ * Maps a logical thread slot to one of the CPUs of a NUMA node, wrapping around when there are more slots than CPUs.
+ * @param node - the id of the node, or -1 for any allowed CPU.
+ * @param slot - the logical slot (0, 1, 2, ...).
+ * @return - the id of the CPU for that slot.
+ */
+int numa_node_cpu(int node, int slot);
+
+
+/**
+ * Restricts the calling thread to the CPUs of a NUMA node.
+ * @param node - the id of the node.
+ * @return 0 on success, -1 on failure.
+ */
+int run_on_numa_node(int node);
+
+
+
+/**
+ * Reads the data and unified caches of a CPU from /sys/devices/system/cpu/cpu<cpu>/cache, sorted by level.
+ * @param cpu - the id of the CPU.
+ * @param caches - filled with the caches.
+ * @param max_caches - the length of caches.
+ * @return - the number of caches read (0 if sysfs doesn't describe them).
+ */
+int read_cache_info(int cpu, struct cache_info* caches, int max_caches);
+
+#endif